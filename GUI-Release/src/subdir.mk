@@ -4,65 +4,107 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../src/AacSink.cpp \
 ../src/Analyzer.cpp \
+../src/AudioSource.cpp \
+../src/BufferPool.cpp \
 ../src/Channel.cpp \
+../src/Convert.cpp \
 ../src/CrosstalkFilter.cpp \
 ../src/CrosstalkGate.cpp \
+../src/DecodeCache.cpp \
 ../src/Encode.cpp \
 ../src/Equalizer.cpp \
+../src/FrameBuffer.cpp \
 ../src/Frequency.cpp \
 ../src/GuiMain.cpp \
+../src/InputQueue.cpp \
 ../src/Log.cpp \
+../src/MappedWave.cpp \
 ../src/Maximizer.cpp \
 ../src/Merge.cpp \
 ../src/MonoMix.cpp \
 ../src/OspacMain.cpp \
+../src/OutputQueue.cpp \
 ../src/Physics.cpp \
+../src/Pipeline.cpp \
+../src/Plan.cpp \
 ../src/Plot.cpp \
+../src/Resampler.cpp \
+../src/SampleBuffer.cpp \
 ../src/SelectiveLeveler.cpp \
 ../src/Skip.cpp \
+../src/Statistics.cpp \
 ../src/StereoMix.cpp \
 ../src/Wave.cpp 
 
 OBJS += \
+./src/AacSink.o \
 ./src/Analyzer.o \
+./src/AudioSource.o \
+./src/BufferPool.o \
 ./src/Channel.o \
+./src/Convert.o \
 ./src/CrosstalkFilter.o \
 ./src/CrosstalkGate.o \
+./src/DecodeCache.o \
 ./src/Encode.o \
 ./src/Equalizer.o \
+./src/FrameBuffer.o \
 ./src/Frequency.o \
 ./src/GuiMain.o \
+./src/InputQueue.o \
 ./src/Log.o \
+./src/MappedWave.o \
 ./src/Maximizer.o \
 ./src/Merge.o \
 ./src/MonoMix.o \
 ./src/OspacMain.o \
+./src/OutputQueue.o \
 ./src/Physics.o \
+./src/Pipeline.o \
+./src/Plan.o \
 ./src/Plot.o \
+./src/Resampler.o \
+./src/SampleBuffer.o \
 ./src/SelectiveLeveler.o \
 ./src/Skip.o \
+./src/Statistics.o \
 ./src/StereoMix.o \
 ./src/Wave.o 
 
 CPP_DEPS += \
+./src/AacSink.d \
 ./src/Analyzer.d \
+./src/AudioSource.d \
+./src/BufferPool.d \
 ./src/Channel.d \
+./src/Convert.d \
 ./src/CrosstalkFilter.d \
 ./src/CrosstalkGate.d \
+./src/DecodeCache.d \
 ./src/Encode.d \
 ./src/Equalizer.d \
+./src/FrameBuffer.d \
 ./src/Frequency.d \
 ./src/GuiMain.d \
+./src/InputQueue.d \
 ./src/Log.d \
+./src/MappedWave.d \
 ./src/Maximizer.d \
 ./src/Merge.d \
 ./src/MonoMix.d \
 ./src/OspacMain.d \
+./src/OutputQueue.d \
 ./src/Physics.d \
+./src/Pipeline.d \
+./src/Plan.d \
 ./src/Plot.d \
+./src/Resampler.d \
+./src/SampleBuffer.d \
 ./src/SelectiveLeveler.d \
 ./src/Skip.d \
+./src/Statistics.d \
 ./src/StereoMix.d \
 ./src/Wave.d 
 
@@ -71,7 +113,7 @@ CPP_DEPS += \
 src/%.o: ../src/%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: Cross G++ Compiler'
-	g++ -DVERSION=\"`cat ../version`\"  -DGUI `fltk-config --cxxflags` -I/usr/local/include -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	g++ -DVERSION=\"`cat ../version`\"  -DGUI `fltk-config --cxxflags` -I/usr/local/include -DNDEBUG -O3 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
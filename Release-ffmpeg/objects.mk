@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lsndfile -lavformat -lavcodec -lavutil
+LIBS := -lsndfile -lavformat -lavcodec -lavutil -pthread
 
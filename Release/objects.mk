@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lsndfile
+LIBS := -lsndfile -pthread
 
@@ -28,6 +28,10 @@ _ospac(){
   --trim
   --help
   --verbosity
+  --plan
+  --max-memory
+  --cache
+  --cache-size
   --normalize
   --no-eqvoice
   --eqvoice
@@ -56,11 +60,16 @@ _ospac(){
   --left
   --to-mono
   --right
+  --load-skip
+  --load-length
   --output
+  --bits
   --mp3
   --quality
   --plot
   --ogg
+  --flac
+  --opus
   )
   local cur=${COMP_WORDS[COMP_CWORD]}
   COMPREPLY=( $(compgen -W "${opts[*]}" -- $cur) )
@@ -27,6 +27,24 @@ completion = {
             description: "Set the verbosity level",
             flag: False,
             zsh: list(range(7)),
+        },
+        "--plan": {
+            description: "Project memory and cost of all stages without processing"
+        }
+    },
+    "Resources": {
+        "--max-memory": {
+            description: "[n] Keep at most n MB of samples in memory, spill the rest to temporary files",
+            flag: False
+        },
+        "--cache": {
+            description: "[dir] Cache decoded compressed inputs in directory dir",
+            flag: False,
+            zsh: "_files -/"
+        },
+        "--cache-size": {
+            description: "[n] Keep at most n MB of decoded inputs in the cache",
+            flag: False
         }
     },
     "Output modes": {
@@ -61,16 +79,28 @@ completion = {
             zsh: "_files"
         },
         "--mp3": {
-            description: "Write final output to the file using external lame",
+            description: "Write final output to the file using libsndfile or lame",
             zsh: "_files"
         },
         "--ogg": {
-            description: "Write final output to the file using external oggenc",
+            description: "Write final output to the file using libsndfile or oggenc",
+            zsh: "_files"
+        },
+        "--flac": {
+            description: "Write final output to the file in flac format",
+            zsh: "_files"
+        },
+        "--opus": {
+            description: "Write final output to the file in opus format",
             zsh: "_files"
         },
         "--quality": {
             description: "Quality from 0-low, 1-standard, 2-high, 3-insane",
             zsh: [0, 1, 2, 3]
+        },
+        "--bits": {
+            description: "Wave output with 16 or 24 bit integer or 32 bit float samples",
+            zsh: [16, 24, 32]
         }
     },
     "Output meta data": {
@@ -238,6 +268,14 @@ completion = {
         "--ascii": {
             description: "[s] [file] Load ascii wave file with sample rate s",
             flag: False
+        },
+        "--load-skip": {
+            description: "[s] Skip first s seconds of following inputs",
+            flag: False
+        },
+        "--load-length": {
+            description: "[s] Load at most s seconds of following inputs",
+            flag: False
         }
     }
 }
@@ -0,0 +1,320 @@
+/**
+ * @file		AacSink.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Streaming aac encoding via libavcodec
+ */
+
+#include "AacSink.h"
+
+#ifdef HAS_FFMPEG
+
+#include <algorithm>
+#include <mutex>
+#include <stdlib.h>
+#include <strings.h>
+
+extern "C" {
+	#include <libavformat/avformat.h>
+	#include <libavcodec/avcodec.h>
+}
+
+#include "Convert.h"
+#include "Log.h"
+
+#undef av_err2str
+#define av_err2str(errnum) av_make_error_string((char*)__builtin_alloca(AV_ERROR_MAX_STRING_SIZE), AV_ERROR_MAX_STRING_SIZE, errnum)
+
+/**
+ * Frame size of encoders that accept any number of samples per frame
+ */
+static const int variableFrameSize=1024;
+
+AacSink::AacSink(const std::string & aName,unsigned channels,unsigned samplerate,int bitrate)
+	: name(aName), formatContext(NULL), codecContext(NULL), stream(NULL), frame(NULL), packet(NULL),
+	  inputChannels(channels), filled(0), pts(0), headerWritten(false), failed(false)
+{
+	// outputs are opened by concurrent threads
+	static std::once_flag registered;
+	std::call_once(registered,av_register_all);
+
+	int error;
+
+	// raw ADTS for .aac, otherwise the container of the extension or MP4
+	std::string::size_type dot=name.rfind('.');
+	const char * container=NULL;
+	if(dot!=std::string::npos && strcasecmp(name.c_str()+dot+1,"aac")==0)
+		container="adts";
+	if(avformat_alloc_output_context2(&formatContext,NULL,container,name.c_str())<0
+	   && avformat_alloc_output_context2(&formatContext,NULL,"mp4",name.c_str())<0)
+	{
+		LOG(logERROR) << "Could not find output file format for " << name << std::endl;
+		formatContext=NULL;
+		return;
+	}
+
+	const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+	if(!codec)
+	{
+		LOG(logERROR) << "AAC Codec not found" << std::endl;
+		release();
+		return;
+	}
+	LOG(logINFO) << "Writing to "<<name << " as " << formatContext->oformat->name
+			     << " using "<<codec->long_name<<std::endl;
+
+	if (!(stream = avformat_new_stream(formatContext, NULL)) || !(codecContext=avcodec_alloc_context3(codec)))
+	{
+		LOG(logERROR) << "Could not allocate encoder" << std::endl;
+		release();
+		return;
+	}
+
+	codecContext->bit_rate=bitrate;
+	LOG(logINFO) << "Using AAC bitrate of " << codecContext->bit_rate << std::endl;
+	codecContext->sample_fmt=AV_SAMPLE_FMT_FLTP;
+
+	bool found=false;
+	for(const enum AVSampleFormat *p=codec->sample_fmts;p && !found && *p!=AV_SAMPLE_FMT_NONE;p++)
+		found=(*p==codecContext->sample_fmt);
+	if(!found)
+	{
+		LOG(logERROR) << "Could not select sample format" << std::endl;
+		release();
+		return;
+	}
+
+	int sampleRate=0;
+	if(codec->supported_samplerates)
+	{
+		for(const int *p=codec->supported_samplerates;*p;p++)
+			if(abs(int(samplerate)-*p)<abs(int(samplerate)-sampleRate))
+				sampleRate=*p;
+	} else
+		sampleRate=44100;
+	codecContext->sample_rate=sampleRate;
+	LOG(logINFO) << "Using AAC samplerate of " << codecContext->sample_rate << std::endl;
+
+	unsigned currentChannels=2;
+	uint64_t channel_layout=AV_CH_LAYOUT_STEREO;
+	if(codec->channel_layouts)
+	{
+		for(const uint64_t *p=codec->channel_layouts;*p;p++)
+		{
+			unsigned count=av_get_channel_layout_nb_channels(*p);
+			if(count>=channels && (currentChannels<channels || count<currentChannels))
+			{
+				channel_layout=*p;
+				currentChannels=count;
+			}
+		}
+	}
+	codecContext->channel_layout=channel_layout;
+	codecContext->channels=currentChannels;
+	LOG(logINFO) << "Using AAC channel count " << codecContext->channels << std::endl;
+
+	codecContext->strict_std_compliance=FF_COMPLIANCE_EXPERIMENTAL;
+	codecContext->time_base.num=1;
+	codecContext->time_base.den=sampleRate;
+	codecContext->codec_type=AVMEDIA_TYPE_AUDIO;
+
+	if (formatContext->oformat->flags & AVFMT_GLOBALHEADER)
+		codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+	if ((error=avcodec_open2(codecContext,codec,NULL))<0)
+	{
+		LOG(logERROR) << "Could not open codec (error '"<<av_err2str(error)<<"')"<< std::endl;
+		release();
+		return;
+	}
+
+	stream->id=formatContext->nb_streams-1;
+	stream->time_base=codecContext->time_base;
+	if((error=avcodec_parameters_from_context(stream->codecpar,codecContext))<0)
+	{
+		LOG(logERROR) << "Could not set stream parameters (error '"<<av_err2str(error)<<"')"<< std::endl;
+		release();
+		return;
+	}
+
+	frame=av_frame_alloc();
+	packet=av_packet_alloc();
+	if(!frame || !packet)
+	{
+		LOG(logERROR) << "Could not allocate frame" << std::endl;
+		release();
+		return;
+	}
+	frame->nb_samples     = codecContext->frame_size>0 ? codecContext->frame_size : variableFrameSize;
+	frame->format         = codecContext->sample_fmt;
+	frame->channel_layout = codecContext->channel_layout;
+	frame->sample_rate    = sampleRate;
+	if(av_frame_get_buffer(frame,0)<0)
+	{
+		LOG(logERROR) << "Could not allocate audio data buffers" << std::endl;
+		release();
+		return;
+	}
+
+	if ((error = avio_open(&formatContext->pb, name.c_str(), AVIO_FLAG_WRITE)) < 0)
+	{
+		LOG(logERROR) << "Could not open output file '"<<name<<"'"
+				      << "(error '"<<av_err2str(error)<<"')"<<std::endl;
+		release();
+		return;
+	}
+
+	if ((error = avformat_write_header(formatContext, NULL)) < 0)
+	{
+		LOG(logERROR) << "Could not write output file header (error '"
+				      << av_err2str(error) << "')"<<std::endl;
+		release();
+		return;
+	}
+	headerWritten=true;
+}
+
+AacSink::~AacSink()
+{
+	if(good())
+	{
+		LOG(logWARNING) << "Output " << name << " was not completed" << std::endl;
+	}
+	release();
+}
+
+void AacSink::release()
+{
+	if(packet)
+		av_packet_free(&packet);
+	if(frame)
+		av_frame_free(&frame);
+	if(codecContext)
+		avcodec_free_context(&codecContext);
+	if(formatContext)
+	{
+		if(formatContext->pb)
+			avio_closep(&formatContext->pb);
+		avformat_free_context(formatContext);
+		formatContext=NULL;
+	}
+	stream=NULL;
+	headerWritten=false;
+}
+
+unsigned AacSink::samplerate() const
+{
+	return codecContext ? codecContext->sample_rate : 0;
+}
+
+bool AacSink::send(AVFrame * frame)
+{
+	int error;
+	if((error=avcodec_send_frame(codecContext,frame))<0)
+	{
+		LOG(logERROR) << "Could not encode frame (error '" << av_err2str(error) << "')"<<std::endl;
+		return false;
+	}
+	while((error=avcodec_receive_packet(codecContext,packet))==0)
+	{
+		// the encoder stamps the packets from the frame timestamps
+		packet->stream_index=stream->index;
+		av_packet_rescale_ts(packet,codecContext->time_base,stream->time_base);
+		error=av_interleaved_write_frame(formatContext,packet);
+		av_packet_unref(packet);
+		if(error<0)
+		{
+			LOG(logERROR) << "Could not write frame (error '" << av_err2str(error) << "')"<<std::endl;
+			return false;
+		}
+	}
+	if(error!=AVERROR(EAGAIN) && error!=AVERROR_EOF)
+	{
+		LOG(logERROR) << "Error receiving encoded packet (error '" << av_err2str(error) << "')"<<std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool AacSink::write(const float * const * channels,std::size_t frames)
+{
+	if(!good())
+		return false;
+
+	const float scale=1/32767.f;
+	int frameSize=frame->nb_samples;
+
+	for(std::size_t done=0;done<frames;)
+	{
+		if(filled==0 && av_frame_make_writable(frame)<0)
+		{
+			LOG(logERROR) << "Could not make frame writable"<<std::endl;
+			failed=true;
+			return false;
+		}
+
+		int items=frameSize-filled;
+		if(std::size_t(items)>frames-done)
+			items=frames-done;
+
+		// planar frames are converted plane by plane
+		for(int c=0;c<codecContext->channels;c++)
+		{
+			float * plane=(float *)frame->extended_data[c]+filled;
+			if(unsigned(c)<inputChannels)
+			{
+				const float * in=channels[c]+done;
+				Convert::interleave(&in,1,items,scale,plane);
+			} else
+				std::fill(plane,plane+items,0.f);
+		}
+		filled+=items;
+		done+=items;
+
+		if(filled==frameSize)
+		{
+			frame->pts=pts;
+			pts+=filled;
+			filled=0;
+			if(!send(frame))
+			{
+				failed=true;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool AacSink::close()
+{
+	if(!good())
+	{
+		release();
+		return false;
+	}
+
+	bool ok=true;
+	if(filled>0)
+	{
+		frame->nb_samples=filled;
+		frame->pts=pts;
+		pts+=filled;
+		filled=0;
+		ok=send(frame);
+	}
+	ok=ok && send(NULL);
+
+	int error;
+	if((error=av_write_trailer(formatContext))<0)
+	{
+		LOG(logERROR) << "Could not write output file trailer (error '" << av_err2str(error) << "')"<<std::endl;
+		ok=false;
+	}
+	release();
+	return ok;
+}
+
+#endif // HAS_FFMPEG
@@ -0,0 +1,105 @@
+/**
+ * @file		AacSink.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Streaming aac encoding via libavcodec
+ */
+
+#ifndef AACSINK_H_
+#define AACSINK_H_
+
+#include "Wave.h" // Nur fuer FFMPEG-Define
+
+#ifdef HAS_FFMPEG
+
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVStream;
+struct AVFrame;
+struct AVPacket;
+
+/**
+ * @brief Push-based sink encoding multi-channel audio blocks to aac
+ *
+ * The counterpart of FfmpegSource for writing: Blocks of any length are
+ * passed to write() as they are produced. They are converted plane by
+ * plane (see Convert) into frames of the frame size of the encoder, and
+ * the encoded packets are muxed into an MP4/M4A container, or into raw
+ * ADTS for names ending in .aac. All encoder state including the
+ * timestamps belongs to the sink, so several outputs may be encoded at
+ * the same time.
+ */
+class AacSink
+{
+	std::string			name;
+	AVFormatContext *	formatContext;
+	AVCodecContext *	codecContext;
+	AVStream *			stream;
+	AVFrame *			frame;
+	AVPacket *			packet;
+	unsigned			inputChannels;
+	int					filled;
+	int64_t				pts;
+	bool				headerWritten;
+	bool				failed;
+
+	/**
+	 * Send a frame to the encoder and mux all packets it returns
+	 * @param frame frame to encode, NULL to flush the encoder
+	 * @return false on errors
+	 */
+	bool send(AVFrame * frame);
+
+	/**
+	 * Release the encoder and the container
+	 */
+	void release();
+
+public:
+	/**
+	 * Open an output file and its encoder
+	 * @param name       file system name of file
+	 * @param channels   number of channels to be written
+	 * @param samplerate preferred sample rate, the encoder may use another
+	 *                   rate (see samplerate())
+	 * @param bitrate    bitrate in bits per second
+	 */
+	AacSink(const std::string & name,unsigned channels,unsigned samplerate,int bitrate);
+	~AacSink();
+
+	/**
+	 * Check if the sink can take samples
+	 * @return false if the file or encoder could not be opened or written
+	 */
+	bool good() const { return headerWritten && !failed; }
+
+	/**
+	 * Sample rate of the encoder, all written channels must have this rate
+	 * @return sample rate
+	 */
+	unsigned samplerate() const;
+
+	/**
+	 * Encode a block of samples in the range of [-32767,32767]
+	 * @param channels samples of each channel
+	 * @param frames   number of frames of block
+	 * @return false on errors
+	 */
+	bool write(const float * const * channels,std::size_t frames);
+
+	/**
+	 * Encode the remaining samples, flush the encoder and complete the file
+	 * @return false on errors
+	 */
+	bool close();
+};
+
+#endif // HAS_FFMPEG
+
+#endif /* AACSINK_H_ */
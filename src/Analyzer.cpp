@@ -28,7 +28,7 @@ std::vector<double> Analyzer::bandedAnalysis(const Channel & c,
 
 	l2*=l2;
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 	{
 		if(sqr(c[i])>l2)
 		{
@@ -0,0 +1,1090 @@
+/**
+ * @file		AudioSource.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Block-wise reading of audio inputs
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <errno.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+extern "C" {
+	#include <sndfile.h>
+}
+
+#include "AudioSource.h"
+#include "Convert.h"
+#include "Log.h"
+
+AudioSource::~AudioSource()
+{
+}
+
+std::size_t AudioSource::skip(std::size_t frames)
+{
+	Channels block;
+	std::size_t skipped=0;
+	while(skipped<frames)
+	{
+		unsigned n=std::min<std::size_t>(frames-skipped,blockFrames);
+		n=read(block,n);
+		if(n==0)
+			break;
+		skipped+=n;
+	}
+	return skipped;
+}
+
+unsigned AudioSource::read(Channels & block,unsigned frames)
+{
+	const unsigned n=channels();
+	if(block.size()!=n)
+		block.resize(n);
+	std::vector<float *> out(n);
+	for(unsigned c=0;c<n;c++)
+	{
+		if(block[c].samplerate()!=samplerate())
+			block[c]=Channel(samplerate(),frames);
+		else
+			block[c].resize(frames);
+		out[c]=block[c].span().data();
+	}
+
+	unsigned hasread=n>0 ? read(&out[0],frames) : 0;
+	if(hasread<frames)
+		for(unsigned c=0;c<n;c++)
+			block[c].resize(hasread);
+	return hasread;
+}
+
+/**
+ * Read a block into float channels directly
+ * @param source   source to read from
+ * @param target   channels with room for the block
+ * @param o        index of first channel of the source in target
+ * @param position frame position of the block
+ * @param frames   maximum number of frames to read
+ * @return number of frames read
+ */
+static unsigned readBlock(AudioSource & source,Channels & target,unsigned o,std::size_t position,unsigned frames,Channels &)
+{
+	std::vector<float *> out(source.channels());
+	for(unsigned c=0;c<out.size();c++)
+		out[c]=target[o+c].span().data()+position;
+	return out.size()>0 ? source.read(&out[0],frames) : 0;
+}
+
+/**
+ * Read a block into channels of other sample types by conversion
+ * @param source   source to read from
+ * @param target   channels with room for the block
+ * @param o        index of first channel of the source in target
+ * @param position frame position of the block
+ * @param frames   maximum number of frames to read
+ * @param block    temporary block
+ * @return number of frames read
+ */
+template<class T>
+static unsigned readBlock(AudioSource & source,std::vector<BasicChannel<T> > & target,unsigned o,std::size_t position,unsigned frames,Channels & block)
+{
+	unsigned n=source.read(block,frames);
+	for(unsigned c=0;c<source.channels();c++)
+	{
+		Span<T> t=target[o+c].span();
+		Span<const float> b=block[c].view();
+		for(unsigned j=0;j<n;j++)
+			t[position+j]=SampleConversion<T>::from(b[j]);
+	}
+	return n;
+}
+
+template<class T>
+std::vector<BasicChannel<T> > & AudioSource::load(AudioSource & source,std::vector<BasicChannel<T> > & target,
+		                                          std::size_t skip,std::size_t length)
+{
+	if(!source.good())
+		return target;
+
+	std::size_t expected=source.frames()>skip ? source.frames()-skip : 0;
+	if(expected>length)
+		expected=length;
+
+	unsigned o=target.size();
+	for(unsigned c=0;c<source.channels();c++)
+		target.push_back(BasicChannel<T>(source.samplerate(),expected));
+
+	if(skip>0)
+		source.skip(skip);
+
+	Channels block;
+	std::size_t position=0;
+	while(position<length && position<target[o].size())
+	{
+		unsigned n=std::min<std::size_t>(target[o].size()-position,blockFrames);
+		if(n>length-position)
+			n=length-position;
+
+		n=readBlock(source,target,o,position,n,block);
+		if(n==0)
+			break;
+		position+=n;
+	}
+
+	// Frames beyond the expected size are collected in blocks of their own,
+	// so the channels are only resized once instead of being copied on
+	// every growth step
+	std::vector<std::vector<BasicChannel<T> > > overflow;
+	std::size_t extra=0;
+	while(position==target[o].size() && position+extra<length)
+	{
+		unsigned n=std::min<std::size_t>(length-position-extra,blockFrames);
+
+		std::vector<BasicChannel<T> > chunk;
+		for(unsigned c=0;c<source.channels();c++)
+			chunk.push_back(BasicChannel<T>(source.samplerate(),n));
+		n=readBlock(source,chunk,0,0,n,block);
+		if(n==0)
+			break;
+		for(unsigned c=0;c<chunk.size();c++)
+			chunk[c].resize(n);
+		overflow.push_back(std::move(chunk));
+		extra+=n;
+	}
+
+	if(position+extra<expected)
+	{
+		LOG(logWARNING) << "Expected size of " << expected << " but read only " << position+extra << std::endl;
+	}
+
+	if(!overflow.empty())
+	{
+		LOG(logDEBUG) << "Read " << extra << " frames beyond the expected size" << std::endl;
+		for(unsigned c=0;c<source.channels();c++)
+		{
+			BasicChannel<T> & t=target[o+c];
+			t.resize(position+extra);
+			Span<T> s=t.span();
+			std::size_t p=position;
+			for(unsigned k=0;k<overflow.size();k++)
+			{
+				Span<const T> b=overflow[k][c].view();
+				std::copy(b.begin(),b.end(),s.begin()+p);
+				p+=b.size();
+				overflow[k][c]=BasicChannel<T>();
+			}
+		}
+	} else
+	if(position<target[o].size())
+		for(unsigned c=0;c<source.channels();c++)
+			target[o+c].resize(position);
+
+	return target;
+}
+
+template Channels & AudioSource::load(AudioSource &,Channels &,std::size_t,std::size_t);
+template ShortChannels & AudioSource::load(AudioSource &,ShortChannels &,std::size_t,std::size_t);
+
+SndfileSource::SndfileSource(const std::string & name) : file(0), rate(0), channelCount(0), frameCount(0)
+{
+	SF_INFO  info;
+	info.format = 0;
+	file = sf_open(name.c_str(),SFM_READ,&info);
+	if(file==NULL)
+	{
+		LOG(logERROR) << "Could not read " << name << std::endl;
+		return;
+	}
+
+	rate=info.samplerate;
+	channelCount=info.channels;
+	frameCount=info.frames;
+
+	LOG(logINFO) << "Reading "<<info.frames<<" frames with "<<info.channels<<" channels with rate "<< info.samplerate << std::endl;
+}
+
+SndfileSource::~SndfileSource()
+{
+	if(file!=0)
+		sf_close(file);
+}
+
+unsigned SndfileSource::read(float * const * channels,unsigned frames)
+{
+	if(file==0)
+		return 0;
+
+	if(buffer.size()<frames*channelCount)
+		buffer.resize(frames*channelCount);
+
+	sf_count_t hasread=sf_readf_float(file,&buffer[0],frames);
+	if(hasread<=0)
+		return 0;
+
+	// normalized to [-1,1], scaled to the 16 bit range without rounding
+	Convert::deinterleave(&buffer[0],channelCount,hasread,32768.f,channels);
+	return hasread;
+}
+
+std::size_t SndfileSource::skip(std::size_t frames)
+{
+	if(file==0)
+		return 0;
+
+	sf_count_t current=sf_seek(file,0,SEEK_CUR);
+	if(current>=0)
+	{
+		sf_count_t target=current+frames;
+		if(target>sf_count_t(frameCount))
+			target=frameCount;
+		if(sf_seek(file,target,SEEK_SET)>=0)
+		{
+			LOG(logDEBUG) << "Seeked to frame " << target << std::endl;
+			return target-current;
+		}
+	}
+	LOG(logDEBUG) << "Input is not seekable, reading skipped frames" << std::endl;
+	return AudioSource::skip(frames);
+}
+
+/**
+ * Chunks of ascii files are at least this large
+ */
+static const std::size_t minimumChunk=1<<20;
+
+/**
+ * Parse a number
+ * @param p     first character of the number
+ * @param end   end of text
+ * @param value parsed number
+ * @return first character after the number, p if there is no valid number
+ */
+static const char * parseNumber(const char * p,const char * end,double & value)
+{
+	const char * start=p;
+	if(p<end && *p=='+')
+		p++;
+#ifdef __cpp_lib_to_chars
+	std::from_chars_result result=std::from_chars(p,end,value);
+	if(result.ec!=std::errc())
+		return start;
+	return result.ptr;
+#else
+	// strtod needs a terminated string
+	char number[64];
+	std::size_t n=0;
+	while(p+n<end && n+1<sizeof(number) && p[n]!=' ' && p[n]!='\t'
+	      && p[n]!='\n' && p[n]!='\r' && p[n]!='#')
+	{
+		number[n]=p[n];
+		n++;
+	}
+	number[n]=0;
+	char * last;
+	errno=0;
+	value=strtod(number,&last);
+	if(last==number || errno==ERANGE)
+		return start;
+	return p+(last-number);
+#endif
+}
+
+/**
+ * Parse the next value, skipping white space and comments
+ * @param p     current character, moved after the value
+ * @param end   end of text
+ * @param value parsed number
+ * @return false if there is no further valid value
+ */
+static bool nextNumber(const char * & p,const char * end,double & value)
+{
+	while(p<end)
+	{
+		char c=*p;
+		if(c=='#')
+			while(p<end && *p!='\n' && *p!='\r')
+				p++;
+		else if(c==' ' || c=='\t' || c=='\n' || c=='\r')
+			p++;
+		else
+		{
+			const char * number=p;
+			p=parseNumber(p,end,value);
+			return p!=number;
+		}
+	}
+	return false;
+}
+
+unsigned AsciiSource::threads=0;
+
+AsciiSource::AsciiSource(const std::string & name,unsigned samplerate,std::size_t skip,std::size_t length)
+	: opened(false), mapping(MAP_FAILED), mappingSize(0), text(0), rate(samplerate), channelCount(1),
+	  frameCount(0), firstFrame(0), position(0), chunk(0), cursor(0), remaining(0)
+{
+	int fd=open(name.c_str(),O_RDONLY);
+	if(fd<0)
+		return;
+	opened=true;
+
+	struct stat info;
+	std::size_t size=0;
+	if(fstat(fd,&info)==0 && S_ISREG(info.st_mode) && info.st_size>0)
+	{
+		size=info.st_size;
+		mapping=mmap(0,size,PROT_READ,MAP_PRIVATE,fd,0);
+	}
+	if(mapping==MAP_FAILED)
+	{
+		// pipes and files that cannot be mapped are read completely
+		char block[65536];
+		ssize_t n;
+		while((n=::read(fd,block,sizeof(block)))>0)
+			content.append(block,n);
+		size=content.size();
+		text=content.data();
+	} else
+	{
+		mappingSize=size;
+		text=(const char *)mapping;
+#ifdef MADV_SEQUENTIAL
+		madvise(mapping,size,MADV_SEQUENTIAL);
+#endif
+	}
+	close(fd);
+
+	parse(size);
+	window(skip,length);
+
+	LOG(logINFO) << "Reading " << frameCount << " frames with " << channelCount << " channels from " << name << std::endl;
+}
+
+AsciiSource::~AsciiSource()
+{
+	if(mapping!=MAP_FAILED)
+		munmap(mapping,mappingSize);
+}
+
+unsigned AsciiSource::workers()
+{
+	unsigned count=threads;
+	if(count==0)
+		count=std::thread::hardware_concurrency();
+	return count>0 ? count : 1;
+}
+
+void AsciiSource::parallel(const std::function<void(std::size_t)> & work)
+{
+	std::atomic<std::size_t> next(0);
+	auto worker=[&]()
+	{
+		for(std::size_t k=next++;k<chunks.size();k=next++)
+			work(k);
+	};
+
+	unsigned count=workers();
+	if(chunks.size()>1 && count>1)
+	{
+		LOG(logDEBUG) << "Processing " << chunks.size() << " chunks with " << count << " threads" << std::endl;
+		std::vector<std::thread> pool;
+		for(unsigned t=0;t<count && t<chunks.size();t++)
+			pool.push_back(std::thread(worker));
+		for(unsigned t=0;t<pool.size();t++)
+			pool[t].join();
+	} else
+		worker();
+}
+
+void AsciiSource::parse(std::size_t size)
+{
+	std::size_t count=size/minimumChunk;
+	if(count>4*workers())
+		count=4*workers();
+	if(count==0)
+		count=1;
+
+	// chunks start at line boundaries, so comments are never split
+	std::vector<std::size_t> bounds(1,0);
+	for(std::size_t k=1;k<count;k++)
+	{
+		std::size_t b=size/count*k;
+		if(b<=bounds.back())
+			continue;
+		while(b<size && text[b-1]!='\n' && text[b-1]!='\r')
+			b++;
+		if(b<size)
+			bounds.push_back(b);
+	}
+	bounds.push_back(size);
+
+	chunks.resize(bounds.size()-1);
+	for(std::size_t k=0;k<chunks.size();k++)
+	{
+		chunks[k].begin=bounds[k];
+		chunks[k].end=bounds[k+1];
+	}
+
+	parallel([&](std::size_t k)
+	{
+		parse(text+chunks[k].begin,text+chunks[k].end,chunks[k]);
+	});
+}
+
+void AsciiSource::parse(const char * p,const char * end,Chunk & chunk)
+{
+	chunk.count=0;
+	chunk.columns=0;
+	chunk.uniform=true;
+	chunk.failed=false;
+	chunk.flatMin=1e99;
+	chunk.flatMax=-1e99;
+	chunk.flatSum=0;
+
+	unsigned column=0;
+	while(p<end)
+	{
+		char c=*p;
+		if(c=='\n' || c=='\r' || c=='#')
+		{
+			if(c=='#')
+				while(p<end && *p!='\n' && *p!='\r')
+					p++;
+			else
+				p++;
+			if(column>0)
+			{
+				if(chunk.columns==0)
+					chunk.columns=column;
+				else if(column!=chunk.columns)
+					chunk.uniform=false;
+			}
+			column=0;
+			continue;
+		}
+		if(c==' ' || c=='\t')
+		{
+			p++;
+			continue;
+		}
+
+		double value;
+		const char * number=p;
+		p=parseNumber(p,end,value);
+		if(p==number)
+		{
+			chunk.failed=true;
+			break;
+		}
+
+		chunk.count++;
+		if(value<chunk.flatMin)
+			chunk.flatMin=value;
+		if(value>chunk.flatMax)
+			chunk.flatMax=value;
+		chunk.flatSum+=value;
+
+		if(column>=chunk.sum.size())
+		{
+			chunk.min.push_back(1e99);
+			chunk.max.push_back(-1e99);
+			chunk.sum.push_back(0);
+		}
+		if(value<chunk.min[column])
+			chunk.min[column]=value;
+		if(value>chunk.max[column])
+			chunk.max[column]=value;
+		chunk.sum[column]+=value;
+		column++;
+	}
+	if(column>0)
+	{
+		if(chunk.columns==0)
+			chunk.columns=column;
+		else if(column!=chunk.columns)
+			chunk.uniform=false;
+	}
+}
+
+void AsciiSource::window(std::size_t skip,std::size_t length)
+{
+	// invalid values end the file
+	for(std::size_t k=0;k<chunks.size();k++)
+		if(chunks[k].failed)
+		{
+			chunks.resize(k+1);
+			break;
+		}
+
+	unsigned columns=0;
+	bool uniform=true;
+	std::size_t total=0;
+	for(std::size_t k=0;k<chunks.size();k++)
+	{
+		total+=chunks[k].count;
+		if(chunks[k].columns==0)
+			continue;
+		if(columns==0)
+			columns=chunks[k].columns;
+		if(!chunks[k].uniform || chunks[k].columns!=columns)
+			uniform=false;
+	}
+	channelCount=uniform && columns>1 ? columns : 1;
+	total/=channelCount;
+
+	frameCount=total>skip ? total-skip : 0;
+	if(frameCount>length)
+		frameCount=length;
+	firstFrame=skip;
+
+	min.assign(channelCount,1e99);
+	max.assign(channelCount,-1e99);
+	std::vector<double> sum(channelCount,0);
+
+	chunk=chunks.size();
+	std::size_t begin=0;
+	for(std::size_t k=0;k<chunks.size();k++)
+	{
+		Chunk & part=chunks[k];
+		part.frame=begin;
+		std::size_t frames=part.count/channelCount;
+		std::size_t from=begin>skip ? begin : skip;
+		std::size_t to=begin+frames<skip+frameCount ? begin+frames : skip+frameCount;
+
+		if(from<to && chunk==chunks.size())
+		{
+			chunk=k;
+			cursor=part.begin;
+			remaining=part.count;
+		}
+
+		if(from>=to)
+		{
+			// chunks outside of the window are not read again
+		} else
+		if(from==begin && to==begin+frames && part.count==frames*channelCount)
+		{
+			for(unsigned c=0;c<channelCount;c++)
+			{
+				double lo=channelCount==1 ? part.flatMin : part.min[c];
+				double hi=channelCount==1 ? part.flatMax : part.max[c];
+				if(lo<min[c])
+					min[c]=lo;
+				if(hi>max[c])
+					max[c]=hi;
+				sum[c]+=channelCount==1 ? part.flatSum : part.sum[c];
+			}
+		} else
+		{
+			// partial chunks are parsed again for the statistics of the window
+			const char * p=text+part.begin;
+			const char * end=text+part.end;
+			for(std::size_t f=begin;f<to;f++)
+			{
+				if(f==from && chunk==k)
+				{
+					cursor=p-text;
+					remaining=part.count-(from-begin)*channelCount;
+				}
+				for(unsigned c=0;c<channelCount;c++)
+				{
+					double value=0;
+					nextNumber(p,end,value);
+					if(f<from)
+						continue;
+					if(value<min[c])
+						min[c]=value;
+					if(value>max[c])
+						max[c]=value;
+					sum[c]+=value;
+				}
+			}
+		}
+		begin+=frames;
+	}
+
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		double null=sum[c]/(frameCount>0 ? frameCount : 1);
+		if(min[c]>null)
+			min[c]=null-1;
+		if(max[c]<null)
+			max[c]=null+1;
+
+		// Kill DC signal...
+		if(2*null-min[c]>max[c])
+			max[c]=2*null-min[c];
+		if(2*null-max[c]<min[c])
+			min[c]=2*null-max[c];
+	}
+}
+
+Channels & AsciiSource::load(Channels & target)
+{
+	std::size_t o=target.size();
+	std::size_t frames=frameCount-position;
+	for(unsigned c=0;c<channelCount;c++)
+		target.push_back(Channel(rate,frames));
+	if(frames==0)
+		return target;
+
+	std::vector<float *> out(channelCount);
+	for(unsigned c=0;c<channelCount;c++)
+		out[c]=target[o+c].span().data();
+
+	// the frames of each chunk are known, so the chunks are filled independently
+	std::size_t first=firstFrame+position;
+	std::size_t last=firstFrame+frameCount;
+	parallel([&](std::size_t k)
+	{
+		const Chunk & part=chunks[k];
+		std::size_t from=part.frame>first ? part.frame : first;
+		std::size_t to=part.frame+part.count/channelCount;
+		if(to>last)
+			to=last;
+		if(from>=to)
+			return;
+
+		const char * p=text+part.begin;
+		const char * end=text+part.end;
+		for(std::size_t f=part.frame;f<to;f++)
+			for(unsigned c=0;c<channelCount;c++)
+			{
+				double value=0;
+				nextNumber(p,end,value);
+				if(f>=from)
+					out[c][f-first]=(value-min[c])/(max[c]-min[c])*64000-32000;
+			}
+	});
+
+	position=frameCount;
+	return target;
+}
+
+unsigned AsciiSource::read(float * const * channels,unsigned frames)
+{
+	if(position>=frameCount)
+		return 0;
+	if(frames>frameCount-position)
+		frames=frameCount-position;
+
+	unsigned n=0;
+	while(n<frames && chunk<chunks.size())
+	{
+		std::size_t available=remaining/channelCount;
+		if(available==0)
+		{
+			chunk++;
+			if(chunk<chunks.size())
+			{
+				cursor=chunks[chunk].begin;
+				remaining=chunks[chunk].count;
+			}
+			continue;
+		}
+		unsigned m=available<frames-n ? available : frames-n;
+		const char * p=text+cursor;
+		const char * end=text+chunks[chunk].end;
+		for(unsigned j=0;j<m;j++)
+			for(unsigned c=0;c<channelCount;c++)
+			{
+				double value=0;
+				nextNumber(p,end,value);
+				channels[c][n+j]=(value-min[c])/(max[c]-min[c])*64000-32000;
+			}
+		cursor=p-text;
+		remaining-=std::size_t(m)*channelCount;
+		n+=m;
+	}
+	position+=n;
+	return n;
+}
+
+#ifdef HAS_FFMPEG
+
+extern "C" {
+	#include <libavformat/avformat.h>
+	#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Convert decoded samples of a frame to float in the range of [-32767,32767]
+ * @param frame    decoded frame
+ * @param format   sample format of the frame
+ * @param channels number of channels
+ * @param first    index of first frame to convert
+ * @param frames   number of frames to convert
+ * @param out      target of the samples of each channel
+ */
+static void convertFrame(const AVFrame * frame,AVSampleFormat format,unsigned channels,
+		                 int first,int frames,float * const * out)
+{
+	// planar formats hold each channel in a plane of its own
+	const bool planar=av_sample_fmt_is_planar(format)==1;
+	const unsigned planes=planar ? channels : 1;
+	const unsigned n=planar ? 1 : channels;
+	const std::size_t offset=std::size_t(first)*n;
+
+	for(unsigned p=0;p<planes;p++)
+	{
+		const uint8_t * in=frame->extended_data[p];
+		float * const * o=out+p;
+		switch(av_get_packed_sample_fmt(format))
+		{
+			case AV_SAMPLE_FMT_U8:
+				// 8bit samples are always unsigned
+				for(unsigned c=0;c<n;c++)
+					for(int i=0;i<frames;i++)
+						o[c][i]=(int(in[offset+std::size_t(i)*n+c])-127)/127.f*32767;
+				break;
+
+			case AV_SAMPLE_FMT_S16:
+				Convert::deinterleave((const short *)in+offset,n,frames,1.f,o);
+				break;
+
+			case AV_SAMPLE_FMT_S32:
+				Convert::deinterleave((const int32_t *)in+offset,n,frames,32767.f/2147483648.f,o);
+				break;
+
+			case AV_SAMPLE_FMT_FLT:
+				Convert::deinterleave((const float *)in+offset,n,frames,32767.f,o);
+				break;
+
+			case AV_SAMPLE_FMT_DBL:
+				Convert::deinterleave((const double *)in+offset,n,frames,32767.f,o);
+				break;
+
+			default:
+				LOG(logERROR) << "Invalid sample format "<<av_get_sample_fmt_name(format)<<std::endl;
+				for(unsigned c=0;c<n;c++)
+					std::fill(o[c],o[c]+frames,0.f);
+				break;
+		}
+	}
+}
+
+FfmpegSource::FfmpegSource(const std::string & name,unsigned stream)
+	: formatContext(NULL), codecContext(NULL), frame(NULL), streamIndex(-1), frameCount(0),
+	  padding(0), flushing(false), finished(false), frameFirst(0), pendingStart(0),
+	  position(0), decoded(0), discard(0)
+{
+	// inputs are opened by concurrent threads
+	static std::once_flag registered;
+	std::call_once(registered,av_register_all);
+
+	int error=0;
+
+	if ((error = avformat_open_input(&formatContext,name.c_str(),NULL,0)) != 0)
+	{
+		LOG(logERROR) << "Could not open " << name << std::endl;
+		formatContext=NULL;
+		return;
+	}
+
+	avformat_find_stream_info(formatContext,NULL);
+
+	unsigned audio=0;
+	for(unsigned i=0;i<formatContext->nb_streams && codecContext==NULL;i++)
+	{
+		if(formatContext->streams[i]->codecpar->codec_type!=AVMEDIA_TYPE_AUDIO)
+			continue;
+		if(audio++!=stream)
+			continue;
+
+		LOG(logINFO) << "Reading " << name << std::endl;
+		LOG(logINFO) << "Stream:        " << i << std::endl;
+
+		AVCodec * codec = avcodec_find_decoder(formatContext->streams[i]->codecpar->codec_id);
+		if ( codec == NULL )
+		{
+			LOG(logERROR) << "No decoder found for this stream." << std::endl;
+			break;
+		}
+		LOG(logINFO) << "Codec:         " << codec->long_name << std::endl;
+		AVCodecContext * context = avcodec_alloc_context3(codec);
+		if ( context == NULL )
+		{
+			LOG(logERROR) << "Codec " << codec->long_name << " failed context allocation." << std::endl;
+			break;
+		}
+
+		if ((error = avcodec_parameters_to_context(context,formatContext->streams[i]->codecpar)) != 0)
+		{
+			LOG(logERROR) << "Codec parameter could not be set, error " << error << std::endl;
+			avcodec_free_context(&context);
+			break;
+		}
+
+		context->request_sample_fmt = av_get_alt_sample_fmt(context->sample_fmt,0);
+
+		if(( error = avcodec_open2(context,codec,NULL))!=0)
+		{
+			LOG(logERROR) << "Opening codec failed, error " << error << std::endl;
+			avcodec_free_context(&context);
+			break;
+		}
+
+		LOG(logINFO) << "Sample format: " << av_get_sample_fmt_name(context->sample_fmt) << std::endl;
+		LOG(logINFO) << "Sample rate:   " << context->sample_rate << std::endl;
+		LOG(logINFO) << "Sample count:  " << formatContext->duration*context->sample_rate/AV_TIME_BASE << std::endl;
+		LOG(logINFO) << "Sample size:   " << av_get_bytes_per_sample(context->sample_fmt) << std::endl;
+		LOG(logINFO) << "Bit rate:      " << context->bit_rate << std::endl;
+		LOG(logINFO) << "Channels:      " << context->channels << std::endl;
+		LOG(logINFO) << "Planar:        " << av_sample_fmt_is_planar(context->sample_fmt) << std::endl;
+		LOG(logINFO) << "Padding:       " << context->initial_padding << std::endl;
+		LOG(logINFO) << "Delay:         " << context->delay << std::endl;
+		LOG(logINFO) << "trailing padding: " << context->trailing_padding << std::endl;
+
+		if((frame=av_frame_alloc())==NULL)
+		{
+			avcodec_free_context(&context);
+			break;
+		}
+
+		codecContext=context;
+		streamIndex=i;
+		padding=context->initial_padding;
+		if(formatContext->duration>0)
+			frameCount=formatContext->duration*context->sample_rate/AV_TIME_BASE;
+		pending.resize(context->channels);
+	}
+
+	if(codecContext==NULL)
+	{
+		avformat_close_input(&formatContext);
+		formatContext=NULL;
+	}
+}
+
+FfmpegSource::~FfmpegSource()
+{
+	if(frame!=NULL)
+		av_frame_free(&frame);
+	if(codecContext!=NULL)
+	{
+		avcodec_close(codecContext);
+		avcodec_free_context(&codecContext);
+	}
+	if(formatContext!=NULL)
+		avformat_close_input(&formatContext);
+}
+
+unsigned FfmpegSource::channels() const
+{
+	return codecContext!=NULL ? codecContext->channels : 0;
+}
+
+unsigned FfmpegSource::samplerate() const
+{
+	return codecContext!=NULL ? codecContext->sample_rate : 0;
+}
+
+bool FfmpegSource::decode()
+{
+	while(!finished)
+	{
+		int error=avcodec_receive_frame(codecContext,frame);
+		if(error==0)
+		{
+			int first=0;
+			if(padding>0)
+			{
+				first=padding<frame->nb_samples ? padding : frame->nb_samples;
+				padding-=first;
+			}
+			if(decoded<0)
+			{
+				// first frame after seeking, locate it by its timestamp
+				AVStream * stream=formatContext->streams[streamIndex];
+				int64_t pts=av_frame_get_best_effort_timestamp(frame);
+				AVRational samples={1,codecContext->sample_rate};
+				if(pts!=AV_NOPTS_VALUE)
+				{
+					if(stream->start_time!=AV_NOPTS_VALUE)
+						pts-=stream->start_time;
+					decoded=av_rescale_q(pts,stream->time_base,samples);
+				}
+				if(pts==AV_NOPTS_VALUE || decoded>discard)
+				{
+					LOG(logDEBUG) << "Seek target missed, decoding from start" << std::endl;
+					av_frame_unref(frame);
+					if(!rewind())
+					{
+						finished=true;
+						break;
+					}
+					continue;
+				}
+			}
+			if(decoded<discard)
+			{
+				int64_t drop=discard-decoded;
+				if(drop>frame->nb_samples-first)
+					drop=frame->nb_samples-first;
+				first+=drop;
+				decoded+=drop;
+			}
+			decoded+=frame->nb_samples-first;
+			frameFirst=first;
+			return true;
+		}
+		if(error==AVERROR_EOF)
+		{
+			finished=true;
+			break;
+		}
+		if(error!=AVERROR(EAGAIN) || flushing)
+		{
+			LOG(logERROR) << "Receive error " << error << std::endl;
+			finished=true;
+			break;
+		}
+
+		AVPacket packet;
+		av_init_packet(&packet);
+		packet.data=NULL;
+		packet.size=0;
+
+		error=av_read_frame(formatContext,&packet);
+		if(error==AVERROR_EOF)
+		{
+			avcodec_send_packet(codecContext,NULL);
+			flushing=true;
+			continue;
+		}
+		if(error)
+		{
+			LOG(logERROR) << "Error during read " << error << std::endl;
+			finished=true;
+			break;
+		}
+		if(packet.stream_index!=streamIndex)
+		{
+			av_packet_unref(&packet);
+			continue;
+		}
+		error=avcodec_send_packet(codecContext,&packet);
+		av_packet_unref(&packet);
+		if(error!=0)
+		{
+			LOG(logERROR) << "Error codec send " << error << std::endl;
+			finished=true;
+		}
+	}
+	return false;
+}
+
+unsigned FfmpegSource::read(float * const * channels,unsigned frames)
+{
+	if(codecContext==NULL || pending.empty())
+		return 0;
+
+	const unsigned channelCount=pending.size();
+	if(targets.size()!=channelCount)
+		targets.resize(channelCount);
+
+	// rest of the previous frame
+	unsigned n=pending[0].size()-pendingStart;
+	if(n>frames)
+		n=frames;
+	for(unsigned c=0;c<channelCount;c++)
+		std::copy(pending[c].begin()+pendingStart,pending[c].begin()+pendingStart+n,channels[c]);
+	pendingStart+=n;
+
+	// frames are converted directly into the block, only the samples
+	// exceeding it are kept for the next block
+	while(n<frames && decode())
+	{
+		unsigned available=frame->nb_samples-frameFirst;
+		unsigned m=frames-n<available ? frames-n : available;
+		for(unsigned c=0;c<channelCount;c++)
+			targets[c]=channels[c]+n;
+		convertFrame(frame,codecContext->sample_fmt,channelCount,frameFirst,m,&targets[0]);
+		n+=m;
+
+		if(m<available)
+		{
+			for(unsigned c=0;c<channelCount;c++)
+			{
+				pending[c].resize(available-m);
+				targets[c]=&pending[c][0];
+			}
+			convertFrame(frame,codecContext->sample_fmt,channelCount,frameFirst+m,available-m,&targets[0]);
+			pendingStart=0;
+		}
+		av_frame_unref(frame);
+	}
+
+	position+=n;
+	return n;
+}
+
+std::size_t FfmpegSource::skip(std::size_t frames)
+{
+	if(codecContext==NULL || pending.empty())
+		return 0;
+
+	// already decoded samples are dropped directly
+	unsigned buffered=pending[0].size()-pendingStart;
+	if(frames<=buffered)
+	{
+		pendingStart+=frames;
+		position+=frames;
+		return frames;
+	}
+
+	AVStream * stream=formatContext->streams[streamIndex];
+	AVRational samples={1,codecContext->sample_rate};
+	int64_t target=position+frames;
+	int64_t timestamp=av_rescale_q(target,samples,stream->time_base);
+	if(stream->start_time!=AV_NOPTS_VALUE)
+		timestamp+=stream->start_time;
+
+	if(av_seek_frame(formatContext,streamIndex,timestamp,AVSEEK_FLAG_BACKWARD)<0)
+	{
+		LOG(logDEBUG) << "Input is not seekable, decoding skipped frames" << std::endl;
+		return AudioSource::skip(frames);
+	}
+	LOG(logDEBUG) << "Seeked to frame " << target << std::endl;
+
+	avcodec_flush_buffers(codecContext);
+	for(unsigned c=0;c<pending.size();c++)
+		pending[c].clear();
+	pendingStart=0;
+	padding=0;
+	flushing=false;
+	finished=false;
+	decoded=-1;
+	discard=target;
+	position=target;
+	return frames;
+}
+
+bool FfmpegSource::rewind()
+{
+	AVStream * stream=formatContext->streams[streamIndex];
+	int64_t start=stream->start_time!=AV_NOPTS_VALUE ? stream->start_time : 0;
+	if(av_seek_frame(formatContext,streamIndex,start,AVSEEK_FLAG_BACKWARD)<0)
+	{
+		LOG(logERROR) << "Could not seek to start of stream" << std::endl;
+		return false;
+	}
+	avcodec_flush_buffers(codecContext);
+	padding=codecContext->initial_padding;
+	flushing=false;
+	decoded=0;
+	return true;
+}
+
+#endif // HAS_FFMPEG
@@ -0,0 +1,345 @@
+/**
+ * @file		AudioSource.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Block-wise reading of audio inputs
+ */
+
+#ifndef AUDIOSOURCE_H_
+#define AUDIOSOURCE_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <stdint.h>
+
+#include "Channel.h"
+
+/**
+ * @brief Pull-based source of multi-channel audio blocks
+ *
+ * An audio source decodes its input on demand: Each call of read() returns
+ * the next block of at most a given number of frames for all channels, so
+ * consumers only need memory for the current block instead of decode
+ * buffers of the full length. Wave::load(), Wave::loadFfmpeg() and
+ * Wave::loadAscii() collect all blocks of a source into channels with
+ * load().
+ */
+class AudioSource
+{
+public:
+	/**
+	 * Default number of frames per block
+	 */
+	static const unsigned blockFrames=65536;
+
+	virtual ~AudioSource();
+
+	/**
+	 * Check if the source could be opened
+	 * @return true if the source delivers samples
+	 */
+	virtual bool     good() const=0;
+
+	/**
+	 * Number of channels of the source
+	 * @return number of channels
+	 */
+	virtual unsigned channels() const=0;
+
+	/**
+	 * Sample rate of the source
+	 * @return samples per second
+	 */
+	virtual unsigned samplerate() const=0;
+
+	/**
+	 * Expected number of frames, which might be an estimate for compressed
+	 * formats
+	 * @return number of frames
+	 */
+	virtual std::size_t frames() const=0;
+
+	/**
+	 * Read the next block of frames directly into sample storage
+	 * @param channels target of the samples of each channel, with room for
+	 *                 the given number of frames
+	 * @param frames   maximum number of frames to read
+	 * @return number of frames read, 0 at the end of the source
+	 */
+	virtual unsigned read(float * const * channels,unsigned frames)=0;
+
+	/**
+	 * Read the next block of frames
+	 * @param block  channels resized to the number of read frames
+	 * @param frames maximum number of frames to read
+	 * @return number of frames read, 0 at the end of the source
+	 */
+	virtual unsigned read(Channels & block,unsigned frames=blockFrames);
+
+	/**
+	 * Skip frames. By default the frames are read and dropped, sources
+	 * supporting random access seek instead.
+	 * @param frames number of frames to skip
+	 * @return number of skipped frames
+	 */
+	virtual std::size_t skip(std::size_t frames);
+
+	/**
+	 * Read all blocks of a source and append them as new channels. Float
+	 * channels are read directly into their storage.
+	 * @param source source to read from
+	 * @param target channels to append the data to
+	 * @param skip   number of frames to skip
+	 * @param length maximum number of frames to read after skip
+	 * @return target
+	 */
+	template<class T>
+	static std::vector<BasicChannel<T> > & load(AudioSource & source,std::vector<BasicChannel<T> > & target,
+			                                    std::size_t skip=0,std::size_t length=~std::size_t(0));
+};
+
+struct SNDFILE_tag;
+
+/**
+ * @brief Audio source reading files via libsndfile
+ *
+ * The samples are read as float, so 24 bit and float files keep their
+ * precision, and are scaled to the range of 16 bit samples.
+ */
+class SndfileSource : public AudioSource
+{
+	SNDFILE_tag *		file;
+	unsigned			rate;
+	unsigned			channelCount;
+	std::size_t			frameCount;
+	std::vector<float>	buffer;
+public:
+	/**
+	 * Open a file for reading
+	 * @param name file system name of file
+	 */
+	explicit SndfileSource(const std::string & name);
+	virtual ~SndfileSource();
+
+	virtual bool     good() const { return file!=0; }
+	virtual unsigned channels() const { return channelCount; }
+	virtual unsigned samplerate() const { return rate; }
+	virtual std::size_t frames() const { return frameCount; }
+	virtual unsigned read(float * const * channels,unsigned frames);
+	using AudioSource::read;
+
+	/**
+	 * Skip frames by seeking in the file, if it is not a pipe
+	 * @param frames number of frames to skip
+	 * @return number of skipped frames
+	 */
+	virtual std::size_t skip(std::size_t frames);
+
+private:
+	SndfileSource(const SndfileSource &);
+	SndfileSource & operator =(const SndfileSource &);
+};
+
+/**
+ * @brief Audio source parsing ascii files with one channel per column
+ *
+ * The file is memory mapped and split at line boundaries into chunks,
+ * which are parsed concurrently. Values are separated by white space, and
+ * comments starting with '#' are discarded until the end of the line. If
+ * all lines hold the same number of values, each column is loaded as a
+ * channel, otherwise all values form a single channel.
+ *
+ * Each channel is rescaled to [-32000,32000] around its mean value. Only
+ * the minimum, maximum and sum of each chunk are kept while parsing, so
+ * the values are never held in memory. Once the rescaling is known,
+ * load() parses the chunks again concurrently straight into the target
+ * channels, while read() delivers the frames block by block. Only the
+ * frames of the given window are delivered and used for the rescaling.
+ */
+class AsciiSource : public AudioSource
+{
+	/**
+	 * Values and statistics of a part of the file
+	 */
+	struct Chunk
+	{
+		std::size_t			begin;		//!< offset of the first character
+		std::size_t			end;		//!< offset after the last character
+		std::size_t			count;		//!< number of valid values
+		std::size_t			frame;		//!< index of the first frame in the file
+		unsigned			columns;	//!< values on the first line, 0 if none
+		bool				uniform;	//!< all lines hold the same number of values
+		bool				failed;		//!< parsing stopped at an invalid value
+		std::vector<double>	min;		//!< minimum of each column
+		std::vector<double>	max;		//!< maximum of each column
+		std::vector<double>	sum;		//!< sum of each column
+		double				flatMin;	//!< minimum of all values
+		double				flatMax;	//!< maximum of all values
+		double				flatSum;	//!< sum of all values
+	};
+
+	std::vector<Chunk>	chunks;
+	bool				opened;
+	void *				mapping;
+	std::size_t			mappingSize;
+	std::string			content;
+	const char *		text;
+	unsigned			rate;
+	unsigned			channelCount;
+	std::size_t			frameCount;
+	std::size_t			firstFrame;
+	std::size_t			position;
+	unsigned			chunk;
+	std::size_t			cursor;
+	std::size_t			remaining;
+	std::vector<double>	min;
+	std::vector<double>	max;
+
+	static unsigned		threads;
+public:
+	/**
+	 * Open and parse an ascii file
+	 * @param name       file system name of file
+	 * @param samplerate sample rate of file
+	 * @param skip       number of frames to skip
+	 * @param length     maximum number of frames to deliver after skip
+	 */
+	AsciiSource(const std::string & name,unsigned samplerate,std::size_t skip=0,std::size_t length=~std::size_t(0));
+	virtual ~AsciiSource();
+
+	/**
+	 * Limit the number of threads parsing one file, e.g. if several files
+	 * are loaded concurrently
+	 * @param count maximum number of threads, 0 for the number of cores
+	 */
+	static void setThreads(unsigned count) { threads=count; }
+
+	virtual bool     good() const { return opened; }
+	virtual unsigned channels() const { return channelCount; }
+	virtual unsigned samplerate() const { return rate; }
+	virtual std::size_t frames() const { return frameCount; }
+	virtual unsigned read(float * const * channels,unsigned frames);
+	using AudioSource::read;
+
+	/**
+	 * Append all frames of the window as channels, the chunks are parsed
+	 * concurrently into the channels. No frames are left for read().
+	 * @param target channels to append the channels to
+	 * @return target
+	 */
+	Channels & load(Channels & target);
+
+private:
+	AsciiSource(const AsciiSource &);
+	AsciiSource & operator =(const AsciiSource &);
+
+	/**
+	 * Number of threads for the chunks
+	 * @return number of threads, at least 1
+	 */
+	static unsigned workers();
+
+	/**
+	 * Process all chunks on a pool of workers()
+	 * @param work function processing the chunk of given index
+	 */
+	void parallel(const std::function<void(std::size_t)> & work);
+
+	/**
+	 * Parse the text concurrently in chunks
+	 * @param size number of characters
+	 */
+	void parse(std::size_t size);
+
+	/**
+	 * Parse a part of the text starting at a line boundary
+	 * @param begin first character
+	 * @param end   end of the part
+	 * @param chunk statistics of the part
+	 */
+	static void parse(const char * begin,const char * end,Chunk & chunk);
+
+	/**
+	 * Determine the channels, select the frames of the window and compute
+	 * the rescaling
+	 * @param skip   number of frames to skip
+	 * @param length maximum number of frames after skip
+	 */
+	void window(std::size_t skip,std::size_t length);
+};
+
+#ifdef HAS_FFMPEG
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVFrame;
+
+/**
+ * @brief Audio source decoding one audio stream via libavcodec
+ */
+class FfmpegSource : public AudioSource
+{
+	AVFormatContext *	formatContext;
+	AVCodecContext *	codecContext;
+	AVFrame *			frame;
+	int					streamIndex;
+	std::size_t			frameCount;
+	int					padding;
+	bool				flushing;
+	bool				finished;
+	int					frameFirst;
+	std::vector<std::vector<float> >	pending;
+	unsigned			pendingStart;
+	std::vector<float *>	targets;
+	int64_t				position;
+	int64_t				decoded;
+	int64_t				discard;
+public:
+	/**
+	 * Open an audio stream of a file for decoding
+	 * @param name   file system name of file
+	 * @param stream index of the audio stream among all audio streams
+	 */
+	FfmpegSource(const std::string & name,unsigned stream=0);
+	virtual ~FfmpegSource();
+
+	virtual bool     good() const { return codecContext!=0; }
+	virtual unsigned channels() const;
+	virtual unsigned samplerate() const;
+	virtual std::size_t frames() const { return frameCount; }
+	virtual unsigned read(float * const * channels,unsigned frames);
+	using AudioSource::read;
+
+	/**
+	 * Skip frames by seeking to the preceding key frame and dropping the
+	 * decoded samples before the target, located by the frame timestamps
+	 * @param frames number of frames to skip
+	 * @return number of skipped frames
+	 */
+	virtual std::size_t skip(std::size_t frames);
+
+private:
+	FfmpegSource(const FfmpegSource &);
+	FfmpegSource & operator =(const FfmpegSource &);
+
+	/**
+	 * Seek back to the start of the stream, for streams without timestamps
+	 * @return false if seeking failed
+	 */
+	bool rewind();
+
+	/**
+	 * Decode the next frame of the stream, its samples from frameFirst on
+	 * belong to the stream
+	 * @return false at the end of the stream or on errors
+	 */
+	bool decode();
+};
+
+#endif // HAS_FFMPEG
+
+#endif /* AUDIOSOURCE_H_ */
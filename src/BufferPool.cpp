@@ -0,0 +1,104 @@
+/**
+ * @file		BufferPool.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Recycling of sample storage between processing stages
+ */
+
+#include <stdlib.h>
+
+#include "BufferPool.h"
+#include "SampleBuffer.h"
+#include "Log.h"
+
+BufferPool * BufferPool::active=0;
+std::mutex   BufferPool::lock;
+
+BufferPool::BufferPool() : idleBytes(0), peakIdleBytes(0),
+		                   requests(0), reused(0), kept(0)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	previous=active;
+	active=this;
+}
+
+BufferPool::~BufferPool()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	clear();
+	active=previous;
+
+	LOG(logDEBUG) << "Buffer pool: " << requests << " requests, "
+			      << reused << " reused, " << kept << " kept, "
+			      << (peakIdleBytes>>20) << " MB peak pool size" << std::endl;
+}
+
+void BufferPool::clear()
+{
+	for(std::multimap<std::size_t,void *>::iterator i=idle.begin();i!=idle.end();i++)
+		free(i->second);
+	idle.clear();
+	idleBytes=0;
+}
+
+void * BufferPool::acquire(std::size_t size,std::size_t & capacity)
+{
+	if(size<minimumSize)
+		return 0;
+
+	std::lock_guard<std::mutex> guard(lock);
+	if(active==0)
+		return 0;
+
+	active->requests++;
+
+	// best fit, wasting at most a quarter of the requested size
+	std::multimap<std::size_t,void *>::iterator i=active->idle.lower_bound(size);
+	if(i==active->idle.end() || i->first>size+size/4)
+		return 0;
+
+	void * storage=i->second;
+	capacity=i->first;
+	active->idle.erase(i);
+	active->idleBytes-=capacity;
+	active->reused++;
+	return storage;
+}
+
+bool BufferPool::release(void * storage,std::size_t capacity)
+{
+	if(capacity<minimumSize)
+		return false;
+
+	std::lock_guard<std::mutex> guard(lock);
+	if(active==0)
+		return false;
+
+	std::size_t limit=SampleBuffer::memoryLimit();
+	if(limit==0 || limit>maxIdle)
+		limit=maxIdle;
+	if(active->idleBytes+capacity>limit)
+		return false;
+
+	active->idle.insert(std::make_pair(capacity,storage));
+	active->idleBytes+=capacity;
+	active->kept++;
+	if(active->idleBytes>active->peakIdleBytes)
+		active->peakIdleBytes=active->idleBytes;
+	return true;
+}
+
+std::size_t BufferPool::idleUsage()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return active!=0 ? active->idleBytes : 0;
+}
+
+void BufferPool::trim()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if(active!=0)
+		active->clear();
+}
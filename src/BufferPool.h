@@ -0,0 +1,108 @@
+/**
+ * @file		BufferPool.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Recycling of sample storage between processing stages
+ */
+
+#ifndef BUFFERPOOL_H_
+#define BUFFERPOOL_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+/**
+ * @brief Pool of released heap storage for reuse by new sample buffers
+ *
+ * Rendering a segment creates and drops many temporary channels of the
+ * same or a similar length, like frequency bands, leveler factors, mixing
+ * targets and resized copies. Without a pool, each of them is a fresh
+ * allocation whose pages are faulted in and cleared by the operating
+ * system, only to be returned shortly after.
+ *
+ * While a pool exists, heap storage of released sample buffers is kept in
+ * the pool instead of being freed, and new sample buffers take the storage
+ * of a released buffer of the same or a slightly larger size. Pools are
+ * scoped: Creating a pool activates it, destroying it frees all kept
+ * storage and reports statistics at debug log level. Small buffers are
+ * left to the system allocator.
+ *
+ * The amount of kept storage is limited by the memory limit of the sample
+ * buffers (see SampleBuffer::setMemoryLimit()) or by maxIdle.
+ */
+class BufferPool
+{
+	std::multimap<std::size_t,void *>	idle;
+	std::size_t			idleBytes;
+	std::size_t			peakIdleBytes;
+	unsigned			requests;
+	unsigned			reused;
+	unsigned			kept;
+	BufferPool *		previous;
+
+	static BufferPool *	active;
+	static std::mutex	lock;
+public:
+	/**
+	 * Buffers smaller than this number of bytes are not pooled
+	 */
+	static const std::size_t minimumSize=65536;
+
+	/**
+	 * Maximum number of bytes kept in the pool without memory limit
+	 */
+	static const std::size_t maxIdle=std::size_t(512)<<20;
+
+	/**
+	 * Create and activate a pool, a previously active pool is suspended
+	 * until this pool is destroyed
+	 */
+	BufferPool();
+
+	/**
+	 * Free all kept storage, report statistics and reactivate the
+	 * previous pool
+	 */
+	virtual ~BufferPool();
+
+	/**
+	 * Take storage of at least given size from the active pool
+	 * @param size     number of bytes needed
+	 * @param capacity actual size of the returned storage in bytes
+	 * @return storage or 0 if there is no suitable storage in the pool
+	 */
+	static void *      acquire(std::size_t size,std::size_t & capacity);
+
+	/**
+	 * Offer heap storage to the active pool
+	 * @param storage  storage allocated by malloc() or calloc()
+	 * @param capacity size of the storage in bytes
+	 * @return true if the pool took the storage, false if it has to be freed
+	 */
+	static bool        release(void * storage,std::size_t capacity);
+
+	/**
+	 * Number of bytes currently kept by the active pool
+	 * @return kept storage in bytes
+	 */
+	static std::size_t idleUsage();
+
+	/**
+	 * Free all storage kept by the active pool
+	 */
+	static void        trim();
+
+private:
+	BufferPool(const BufferPool &);
+	BufferPool & operator =(const BufferPool &);
+
+	/**
+	 * Free all kept storage of this pool, lock must be held
+	 */
+	void clear();
+};
+
+#endif /* BUFFERPOOL_H_ */
@@ -9,194 +9,473 @@
 
 
 #include <math.h>
+#include <string.h>
+#include <assert.h>
 #include <iostream>
+#include <algorithm>
 
 #include "Channel.h"
+#include "Resampler.h"
 #include "Log.h"
 
-float Channel::zero=0;
+template<class T>
+T BasicChannel<T>::zero=0;
 
-Channel::Channel()
+template<class T>
+const std::shared_ptr<SampleBuffer> & BasicChannel<T>::empty()
+{
+	static const std::shared_ptr<SampleBuffer> buffer=std::make_shared<SampleBuffer>();
+	return buffer;
+}
+
+template<class T>
+BasicChannel<T>::BasicChannel() : data(empty())
 {
 	rate=44100;
 }
 
-Channel::Channel(unsigned aRate) : rate(aRate)
+template<class T>
+BasicChannel<T>::BasicChannel(unsigned aRate) : rate(aRate), data(empty())
+{
+}
+
+template<class T>
+BasicChannel<T>::BasicChannel(unsigned aRate,const std::vector<T> & aData) : rate(aRate), data(std::make_shared<SampleBuffer>(aData.data(),aData.size()*sizeof(T)))
+{
+}
+
+template<class T>
+BasicChannel<T>::BasicChannel(unsigned aRate,std::size_t size) : rate(aRate), data(std::make_shared<SampleBuffer>(size*sizeof(T)))
+{
+}
+
+template<class T>
+BasicChannel<T>::BasicChannel(unsigned aRate,const std::shared_ptr<SampleBuffer> & aData) : rate(aRate), data(aData)
 {
 }
 
-Channel::Channel(unsigned aRate,const std::vector<float> & aData) : rate(aRate), data(aData)
+template<class T>
+template<class U>
+BasicChannel<T>::BasicChannel(const BasicChannel<U> & other) : rate(other.samplerate()), data(std::make_shared<SampleBuffer>(other.size()*sizeof(T)))
 {
+	Span<const U> source=other.view();
+	T * target=samples();
+	for(std::size_t i=0;i<source.size();i++)
+		target[i]=SampleConversion<T>::from(source[i]);
 }
 
-Channel::Channel(unsigned aRate,unsigned size) : rate(aRate), data(std::vector<float>(size))
+template<class T>
+BasicChannel<T>::BasicChannel(const BasicChannel & other) : rate(other.rate), data(other.data), stats(other.stats)
 {
 }
 
-Channel::~Channel()
+template<class T>
+BasicChannel<T>::BasicChannel(BasicChannel && other) : rate(other.rate), data(std::move(other.data)), stats(other.stats)
 {
+	other.data=empty();
+	other.stats.reset();
 }
 
-float & Channel::operator [](int index)
+template<class T>
+BasicChannel<T>::~BasicChannel()
 {
-	if(index<0 || (unsigned)index>=data.size())
+}
+
+template<class T>
+BasicChannel<T> & BasicChannel<T>::operator =(const BasicChannel & other)
+{
+	rate=other.rate;
+	data=other.data;
+	stats=other.stats;
+	return *this;
+}
+
+template<class T>
+BasicChannel<T> & BasicChannel<T>::operator =(BasicChannel && other)
+{
+	if(this!=&other)
+	{
+		rate=other.rate;
+		data=std::move(other.data);
+		stats=other.stats;
+		other.data=empty();
+		other.stats.reset();
+	}
+	return *this;
+}
+
+template<class T>
+void BasicChannel<T>::detach()
+{
+	if(data.use_count()>1)
+		data=std::make_shared<SampleBuffer>(*data);
+}
+
+template<class T>
+bool BasicChannel<T>::shared() const
+{
+	return data.use_count()>1;
+}
+
+template<class T>
+T & BasicChannel<T>::operator [](std::ptrdiff_t index)
+{
+	if(index<0 || (std::size_t)index>=size())
 	{
 		zero=0;
 		return zero;
 	}
-	return data[index];
+	detach();
+	stats.reset();
+	return samples()[index];
 }
-float   Channel::operator [](int index) const
+
+template<class T>
+T       BasicChannel<T>::operator [](std::ptrdiff_t index) const
 {
-	if(index<0 || (unsigned)index>=data.size())
+	if(index<0 || (std::size_t)index>=size())
 	{
 		return 0;
 	}
-	return data[index];
+	return samples()[index];
 }
 
-unsigned Channel::size() const
+template<class T>
+Span<T> BasicChannel<T>::span()
 {
-	return data.size();
+	detach();
+	stats.reset();
+	return Span<T>(samples(),size());
 }
 
-unsigned Channel::samplerate() const
+template<class T>
+Span<const T> BasicChannel<T>::view() const
+{
+	return Span<const T>(samples(),size());
+}
+
+template<class T>
+PaddedView<T> BasicChannel<T>::padded(unsigned halo) const
+{
+	return PaddedView<T>(view(),halo);
+}
+
+template<class T>
+std::size_t BasicChannel<T>::size() const
+{
+	return data->size()/sizeof(T);
+}
+
+template<class T>
+unsigned BasicChannel<T>::samplerate() const
 {
 	return rate;
 }
 
-double Channel::l2norm(void) const
+#ifndef NDEBUG
+/**
+ * Bitwise comparison of statistics, which also holds for NaN samples
+ * @param a first value
+ * @param b second value
+ * @return true if the values are identical
+ */
+template<class U>
+static bool identical(U a,U b)
 {
-	double sum=0.0;
-	for(unsigned i=0;i<data.size();i++)
-		sum+=sqr<float>(data[i]);
-	if(sum!=0.0)
-		sum/=data.size();
-	return sqrt(sum);
+	return memcmp(&a,&b,sizeof(U))==0;
 }
+#endif
 
-double  Channel::l2upnorm(float limit) const
+template<class T>
+const ChannelStatistics & BasicChannel<T>::norms() const
 {
-	double sum=0.0;
-	int count=0;
-	float v;
-	limit*=limit;
-	for(unsigned i=0;i<data.size();i++)
+	if(!stats.hasNorms)
 	{
-		v=sqr<float>(data[i]);
-		if(v>limit)
-		{
-			sum+=v;
-			count++;
-		}
+		Statistics::norms(view(),stats.sumSquares,stats.maxAbs);
+		stats.hasNorms=true;
 	}
-	if(sum!=0.0)
-		sum/=count;
-	return sqrt(sum);
+#ifndef NDEBUG
+	else
+	{
+		// a span written to after the norms were cached leaves them stale
+		double sumSquares;
+		float  maxAbs;
+		Statistics::norms(view(),sumSquares,maxAbs);
+		assert(identical(sumSquares,stats.sumSquares) && identical(maxAbs,stats.maxAbs));
+	}
+#endif
+	return stats;
 }
-double  Channel::l2downnorm(float limit) const
+
+template<class T>
+const ChannelStatistics & BasicChannel<T>::split(float limit) const
 {
-	double sum=0.0;
-	int count=0;
-	float v;
-	limit*=limit;
-	for(unsigned i=0;i<data.size();i++)
+	if(!stats.hasSplit || stats.splitLimit!=limit)
 	{
-		v=sqr<float>(data[i]);
-		if(v<limit)
-		{
-			sum+=v;
-			count++;
-		}
+		Statistics::split(view(),limit*limit,
+				          stats.upSquares,stats.upCount,
+				          stats.downSquares,stats.downCount);
+		stats.splitLimit=limit;
+		stats.hasSplit=true;
+	}
+#ifndef NDEBUG
+	else
+	{
+		double      upSquares,downSquares;
+		std::size_t upCount,downCount;
+		Statistics::split(view(),limit*limit,upSquares,upCount,downSquares,downCount);
+		assert(identical(upSquares,stats.upSquares) && upCount==stats.upCount
+		       && identical(downSquares,stats.downSquares) && downCount==stats.downCount);
 	}
+#endif
+	return stats;
+}
+
+template<class T>
+double BasicChannel<T>::l2norm(void) const
+{
+	double sum=norms().sumSquares;
 	if(sum!=0.0)
-		sum/=count;
+		sum/=size();
 	return sqrt(sum);
 }
 
+template<class T>
+double  BasicChannel<T>::l2upnorm(float limit) const
+{
+	const ChannelStatistics & s=split(limit);
+	double sum=s.upSquares;
+	if(sum!=0.0)
+		sum/=s.upCount;
+	return sqrt(sum);
+}
 
-double Channel::linfnorm(void) const
+template<class T>
+double  BasicChannel<T>::l2downnorm(float limit) const
 {
-	float max=0;
-	for(unsigned i=0;i<data.size();i++)
+	const ChannelStatistics & s=split(limit);
+	double sum=s.downSquares;
+	if(sum!=0.0)
+		sum/=s.downCount;
+	return sqrt(sum);
+}
+
+template<class T>
+double BasicChannel<T>::linfnorm(void) const
+{
+	return norms().maxAbs;
+}
+
+/**
+ * Average blocks of samples, target may be the same as source
+ * @param d      source samples
+ * @param size   number of source samples
+ * @param target target samples, size/factor samples are written
+ * @param factor number of samples per block
+ */
+template<class T>
+static void downsampleBlocks(const T * d,std::size_t size,T * target,unsigned factor)
+{
+	std::size_t newSize=size/factor;
+	float acc;
+	for(std::size_t i=0,j=0;j<newSize;j++)
 	{
-		if(data[i]>max)
-			max=data[i];
-		if(-data[i]>max)
-			max=-data[i];
+		acc=0;
+		for(unsigned k=0;k<factor && i<size;k++)
+			acc+=d[i++];
+		target[j]=SampleConversion<T>::from(acc/factor);
 	}
-	return max;
 }
 
-Channel Channel::downsample(unsigned factor) const
+/**
+ * Root mean square of blocks of samples, target may be the same as source
+ * @param d      source samples
+ * @param size   number of source samples
+ * @param target target samples, size/factor samples are written
+ * @param factor number of samples per block
+ */
+template<class T>
+static void downsampleEnergyBlocks(const T * d,std::size_t size,T * target,unsigned factor)
 {
-	if(factor>0)
+	std::size_t newSize=size/factor;
+	float acc;
+	for(std::size_t i=0,j=0;j<newSize;j++)
 	{
-		unsigned newSize=data.size()/factor;
-		std::vector<float> target=std::vector<float>(newSize);
-		float acc;
-		for(unsigned i=0,j=0;j<newSize;j++)
+		acc=0;
+		for(unsigned k=0;k<factor && i<size;k++)
 		{
-			acc=0;
-			for(unsigned k=0;k<factor && i<data.size();k++)
-				acc+=data[i++];
-			target[j]=acc/factor;
+			float v=d[i++];
+			acc+=v*v;
 		}
-		return Channel(rate/factor,target);
+		target[j]=SampleConversion<T>::from(sqrt(acc/factor));
+	}
+}
+
+template<class T>
+BasicChannel<T> BasicChannel<T>::downsample(unsigned factor) const &
+{
+	if(factor>0)
+	{
+		Span<const T> d=view();
+		BasicChannel result(rate/factor,d.size()/factor);
+		downsampleBlocks(d.data(),d.size(),result.span().data(),factor);
+		return result;
 	} else
 		return *this;
 }
 
-Channel Channel::downsampleEnergy(unsigned factor) const
+template<class T>
+BasicChannel<T> BasicChannel<T>::downsample(unsigned factor) &&
 {
 	if(factor>0)
 	{
-		unsigned newSize=data.size()/factor;
-		std::vector<float> target=std::vector<float>(newSize);
-		float acc;
-		for(unsigned i=0,j=0;j<newSize;j++)
-		{
-			acc=0;
-			for(unsigned k=0;k<factor && i<data.size();k++)
-				acc+=sqr(data[i++]);
-			target[j]=sqrt(acc/factor);
-		}
-		return Channel(rate/factor,target);
+		Span<T> d=span();
+		downsampleBlocks(d.data(),d.size(),d.data(),factor);
+		resize(d.size()/factor);
+		rate/=factor;
+	}
+	return std::move(*this);
+}
+
+template<class T>
+BasicChannel<T> BasicChannel<T>::downsampleEnergy(unsigned factor) const &
+{
+	if(factor>0)
+	{
+		Span<const T> d=view();
+		BasicChannel result(rate/factor,d.size()/factor);
+		downsampleEnergyBlocks(d.data(),d.size(),result.span().data(),factor);
+		return result;
 	} else
 		return *this;
 }
 
-Channel Channel::resizeTo(unsigned size) const
+template<class T>
+BasicChannel<T> BasicChannel<T>::downsampleEnergy(unsigned factor) &&
+{
+	if(factor>0)
+	{
+		Span<T> d=span();
+		downsampleEnergyBlocks(d.data(),d.size(),d.data(),factor);
+		resize(d.size()/factor);
+		rate/=factor;
+	}
+	return std::move(*this);
+}
+
+template<class T>
+BasicChannel<T> BasicChannel<T>::resizeTo(std::size_t size) const &
 {
-	std::vector<float> target=std::vector<float>(size);
-	unsigned i;
-	for(i=0;i<size && i<data.size();i++)
-		target[i]=data[i];
+	if(size==this->size())
+		return *this;
+
+	Span<const T> d=view();
+	BasicChannel result(rate,size);
+	Span<T> target=result.span();
+	std::size_t i;
+	for(i=0;i<size && i<d.size();i++)
+		target[i]=d[i];
 	for(;i<size;i++)
 		target[i]=0;
-	return Channel(rate,target);
+	return result;
+}
+
+template<class T>
+BasicChannel<T> BasicChannel<T>::resizeTo(std::size_t size) &&
+{
+	resize(size);
+	return std::move(*this);
+}
+
+template<class T>
+void BasicChannel<T>::resize(std::size_t size)
+{
+	if(size==this->size())
+		return;
+
+	if(data.use_count()>1)
+	{
+		*this=resizeTo(size);
+		return;
+	}
+	data->resize(size*sizeof(T));
+	stats.reset();
+}
+
+template<class T>
+void BasicChannel<T>::reserve(std::size_t size)
+{
+	if(size<=capacity())
+		return;
+	detach();
+	data->reserve(size*sizeof(T));
+}
+
+template<class T>
+std::size_t BasicChannel<T>::capacity() const
+{
+	return data->reserved()/sizeof(T);
+}
+
+template<class T>
+void BasicChannel<T>::resample(unsigned newRate)
+{
+	if(newRate!=rate)
+		*this=resampleTo(newRate);
 }
 
-Channel Channel::resampleTo(unsigned newRate) const
+template<class T>
+BasicChannel<T> BasicChannel<T>::resampleTo(unsigned newRate) &&
 {
-	unsigned newSize=(data.size()*newRate)/rate;
-	std::vector<float> target=std::vector<float>(newSize);
+	resample(newRate);
+	return std::move(*this);
+}
+
+template<class T>
+BasicChannel<T> BasicChannel<T>::resampleTo(unsigned newRate) const &
+{
+	if(newRate==rate)
+		return *this;
+
+	Span<const T> d=view();
+	Resampler resampler(rate,newRate);
+	std::size_t newSize=resampler.outputLength(d.size());
+	BasicChannel result(newRate,newSize);
+	Span<T> target=result.span();
 	LOG(logDEBUG) << "Old rate "<< rate << " New Rate: " << newRate << std::endl;
-	LOG(logDEBUG) << "Old size " << data.size() << " New Size: " << newSize << std::endl;
+	LOG(logDEBUG) << "Old size " << d.size() << " New Size: " << newSize << std::endl;
 
-	unsigned oldSize=data.size();
+	const unsigned block=65536;
+	std::vector<float> in(block);
+	std::vector<float> out;
+	std::size_t written=0;
 
-	// TODO: Only nearest "interpolation"...
-	for(unsigned i=0;i<newSize;i++)
+	for(std::size_t i=0;i<d.size();i+=block)
 	{
-		int j=(long(i)*oldSize)/newSize;
-		target[i]=data[j];
+		unsigned n=std::min<std::size_t>(block,d.size()-i);
+		for(unsigned j=0;j<n;j++)
+			in[j]=d[i+j];
+		out.resize(resampler.outputLength(i+n)-written+1);
+		unsigned m=resampler.process(&in[0],n,&out[0],out.size());
+		for(unsigned j=0;j<m;j++)
+			target[written+j]=SampleConversion<T>::from(out[j]);
+		written+=m;
 	}
+	out.resize(newSize-written+1);
+	unsigned m=resampler.finish(&out[0],out.size());
+	for(unsigned j=0;j<m && written+j<newSize;j++)
+		target[written+j]=SampleConversion<T>::from(out[j]);
 
 	LOG(logDEBUG) << "done"<< std::endl;
-	return Channel(newRate,target);
+	return result;
 }
 
+template class BasicChannel<short>;
+template class BasicChannel<float>;
+
+template BasicChannel<short>::BasicChannel(const BasicChannel<float> &);
+template BasicChannel<float>::BasicChannel(const BasicChannel<short> &);
+
 unsigned unifiedSamplerate(Channels &a)
 {
 	unsigned samplerate=0;
@@ -207,14 +486,14 @@ unsigned unifiedSamplerate(Channels &a)
 
 	for(unsigned c=0;c<a.size();c++)
 		if(a[c].samplerate()<samplerate)
-			a[c]=a[c].resampleTo(samplerate);
+			a[c].resample(samplerate);
 
 	return samplerate;
 }
 
-unsigned unifiedLength(Channels &a)
+std::size_t unifiedLength(Channels &a)
 {
-	unsigned len=0;
+	std::size_t len=0;
 
 	for(unsigned c=0;c<a.size();c++)
 		if(a[c].size()>len)
@@ -222,7 +501,7 @@ unsigned unifiedLength(Channels &a)
 
 	for(unsigned c=0;c<a.size();c++)
 		if(a[c].size()<len)
-			a[c]=a[c].resizeTo(len);
+			a[c].resize(len);
 
 	return len;
 }
@@ -10,70 +10,198 @@
 #ifndef CHANNEL_H_
 #define CHANNEL_H_
 
+#include <math.h>
 #include <vector>
+#include <memory>
+
+#include "Span.h"
+#include "SampleBuffer.h"
+#include "Statistics.h"
+
+/**
+ * Conversion of a single sample to the sample type T
+ */
+template<class T>
+struct SampleConversion
+{
+	template<class U>
+	static T from(U value) { return T(value); }
+};
+
+/**
+ * Conversion of a single sample to 16 bit integer, rounded and saturated
+ */
+template<>
+struct SampleConversion<short>
+{
+	static short from(short value) { return value; }
+
+	template<class U>
+	static short from(U value)
+	{
+		if(value>=32767)
+			return 32767;
+		if(value<=-32768)
+			return -32768;
+		return short(lrint(value));
+	}
+};
 
 /**
  * @brief Audio channel abstraction class
  *
- * TODO: Switch to auto_ptr<float> to avoid copy operations at assignments.
- * TODO: Virtualization of memory segments to avoid full memory operations.
+ * The channel is a template on the sample type: Most filters work on float
+ * samples (Channel), while 16 bit integer samples (ShortChannel) halve the
+ * memory of loaded raw tracks. Channels of different sample types are
+ * converted explicitly by the converting constructor, conversions to
+ * integer samples are rounded and saturated.
+ *
+ * The sample data is reference counted and shared between copies of a
+ * channel (copy-on-write): Copying or assigning a channel is cheap, and
+ * the samples are only duplicated when a shared channel is modified through
+ * one of the non-const accessors. Note that references returned by the
+ * non-const accessors must not be kept across copies of the channel.
+ *
+ * Transformations like resizeTo() return a new channel, and callers that
+ * replace the original channel should use the in-place variants like
+ * resize() instead. On temporary channels, e.g. std::move(c).resizeTo(n),
+ * the transformations work in place as well. Resizing keeps the storage
+ * of unshared sample data, so shrinking and growing again is cheap.
+ *
+ * The samples are held in a SampleBuffer, which is moved to a memory mapped
+ * temporary file if the memory limit of all buffers is exceeded.
+ *
+ * The norms are computed in fused passes (see Statistics) and cached until
+ * the channel is modified through span() or the non-const accessor. Thus,
+ * a span must not be written to after norms have been requested. Builds
+ * without NDEBUG recompute cached norms and assert that they are unchanged.
  */
-class Channel
+template<class T>
+class BasicChannel
 {
 	unsigned     	   rate;
-	std::vector<float> data;
-	static float	   zero;
+	std::shared_ptr<SampleBuffer> data;
+	mutable ChannelStatistics	stats;
+	static T		   zero;
 public:
+	/**
+	 * Type of a single sample
+	 */
+	typedef T Sample;
+
 	/**
 	 * Create a new audio channel.
 	 */
-	Channel();
+	BasicChannel();
 
 	/**
 	 * Create an audio channel with given sample rate
 	 * @param rate sample rate in Hertz (1/s)
 	 */
-	Channel(unsigned rate);
+	BasicChannel(unsigned rate);
 
 	/**
 	 * Create an audio channel with given rate and sample data
 	 * @param rate sample rate in Hertz (1/s)
-	 * @param data audio data as float vector
+	 * @param data audio data as vector of samples
 	 */
-	Channel(unsigned rate, const std::vector<float> & data);
+	BasicChannel(unsigned rate, const std::vector<T> & data);
 
 	/**
 	 * Create an audio channel with given rate and number of samples
 	 * @param rate sample rate in Hetz (1/s)
 	 * @param size number of samples
 	 */
-	Channel(unsigned rate, unsigned size);
+	BasicChannel(unsigned rate, std::size_t size);
 
-	virtual ~Channel();
+	/**
+	 * Create an audio channel on given sample storage, e.g. a mapped range
+	 * of an input file
+	 * @param rate sample rate in Hertz (1/s)
+	 * @param data sample storage, its size a multiple of the sample size
+	 */
+	BasicChannel(unsigned rate, const std::shared_ptr<SampleBuffer> & data);
+
+	/**
+	 * Create a copy of a channel with a different sample type. Samples
+	 * converted to integer types are rounded and saturated.
+	 * @param other channel to be converted
+	 */
+	template<class U>
+	explicit BasicChannel(const BasicChannel<U> & other);
+
+	/**
+	 * Create a copy of a channel sharing the sample data
+	 * @param other channel to be copied
+	 */
+	BasicChannel(const BasicChannel & other);
+
+	/**
+	 * Take over the sample data of a channel, which is left empty
+	 * @param other channel to be moved
+	 */
+	BasicChannel(BasicChannel && other);
+
+	virtual ~BasicChannel();
+
+	/**
+	 * Share the sample data of another channel
+	 * @param other channel to be copied
+	 * @return this channel
+	 */
+	BasicChannel & operator =(const BasicChannel & other);
+
+	/**
+	 * Take over the sample data of another channel, which is left empty
+	 * @param other channel to be moved
+	 * @return this channel
+	 */
+	BasicChannel & operator =(BasicChannel && other);
 
 	/**
 	 * Access a sample for read/write access
 	 * The bounds are checked on the index and an impostor is returned
 	 * in case of out-of-bounds requests.
 	 * @param index of sample
-	 * @return float reference on sample
+	 * @return reference on sample
 	 */
-	float & operator [](int);
+	T &     operator [](std::ptrdiff_t);
 
 	/**
 	 * Access to a sample with read only access
 	 * The bounds are checked on the index and zero is returned in case of
 	 * out-of-bounds requests.
 	 * @param index of sample
-	 * @return float value of sample
+	 * @return value of sample
+	 */
+	T       operator [](std::ptrdiff_t) const;
+
+	/**
+	 * Unchecked read/write view on all samples of this channel for inner
+	 * loops. Shared sample data is copied before the view is returned.
+	 * @return span on sample data
+	 */
+	Span<T> span();
+
+	/**
+	 * Unchecked read only view on all samples of this channel
+	 * @return span on sample data
+	 */
+	Span<const T> view() const;
+
+	/**
+	 * Read only copy of all samples with zero samples before and after
+	 * the data, for windowed filters reaching beyond the channel boundaries.
+	 * @param halo number of zero samples on either side
+	 * @return padded copy of sample data
 	 */
-	float   operator [](int) const;
+	PaddedView<T> padded(unsigned halo) const;
 
 	/**
 	 * Number of samples in this channel
 	 * @return number of samples
 	 */
-	unsigned size() const;
+	std::size_t size() const;
 
 	/**
 	 * Sample rate of this channel
@@ -81,6 +209,12 @@ public:
 	 */
 	unsigned samplerate() const;
 
+	/**
+	 * Check if the sample data is currently shared with other channels
+	 * @return true if a modification would copy the sample data
+	 */
+	bool     shared() const;
+
 	/**
 	 * Returns the l2-norm of the channel normalized to one sample.
 	 * @f[ ||u||_2:=\sqrt{ \frac1n \sum_{i=0}^{n-1} u_i^2 } @f]
@@ -122,14 +256,29 @@ public:
 	 * @param factor downsample factor
 	 * @return new channel with a new sample frequency divided by the factor
 	 */
-	Channel downsample(unsigned) const;
+	BasicChannel downsample(unsigned) const &;
+
+	/**
+	 * Downsample a temporary channel by given factor in place
+	 * @param factor downsample factor
+	 * @return this channel with a new sample frequency divided by the factor
+	 */
+	BasicChannel downsample(unsigned) &&;
 
 	/**
 	 * Downsample the channel by given factor and square the values
 	 * @param factor downsample factor
 	 * @return new channel with sample frequency divided by the factor
 	 */
-	Channel downsampleEnergy(unsigned) const;
+	BasicChannel downsampleEnergy(unsigned) const &;
+
+	/**
+	 * Downsample a temporary channel by given factor and square the values
+	 * in place
+	 * @param factor downsample factor
+	 * @return this channel with sample frequency divided by the factor
+	 */
+	BasicChannel downsampleEnergy(unsigned) &&;
 
 
 	/**
@@ -137,25 +286,112 @@ public:
 	 * @param size new number of samples
 	 * @return channel with given number of samples
 	 */
-	Channel resizeTo(unsigned) const;
+	BasicChannel resizeTo(std::size_t) const &;
+
+	/**
+	 * Resize a temporary channel in place
+	 * @param size new number of samples
+	 * @return this channel with given number of samples
+	 */
+	BasicChannel resizeTo(std::size_t) &&;
 
 	/**
 	 * Create a copy of this channel with given sample rate
 	 * @param newRate sample rate of target channel
 	 * @return channel with given sample rate
 	 */
-	Channel resampleTo(unsigned) const;
+	BasicChannel resampleTo(unsigned) const &;
+
+	/**
+	 * Resample a temporary channel
+	 * @param newRate sample rate of target channel
+	 * @return this channel with given sample rate
+	 */
+	BasicChannel resampleTo(unsigned) &&;
+
+	/**
+	 * Change the number of samples of this channel. New samples are zero.
+	 * Unless the sample data is shared, the storage is kept when shrinking
+	 * and reused when growing again.
+	 * @param size new number of samples
+	 */
+	void     resize(std::size_t size);
+
+	/**
+	 * Prepare the storage for given number of samples, so resize() does
+	 * not need to reallocate up to this size
+	 * @param size number of samples
+	 */
+	void     reserve(std::size_t size);
+
+	/**
+	 * Number of samples that fit into the storage without reallocation
+	 * @return number of samples
+	 */
+	std::size_t capacity() const;
+
+	/**
+	 * Change the sample rate of this channel
+	 * @param newRate new sample rate in Hertz (1/s)
+	 */
+	void     resample(unsigned newRate);
 
 private:
-	template<class T>
-	static T sqr(const T&a){return a*a;}
+	template<class S>
+	static S sqr(const S&a){return a*a;}
+
+	/**
+	 * Pointer to the first sample without copy-on-write
+	 * @return pointer to sample data
+	 */
+	T *       samples() const { return (T*)data->data(); }
+
+	/**
+	 * Sum of squares and maximum absolute value, computed on first use
+	 * @return cached statistics
+	 */
+	const ChannelStatistics & norms() const;
+
+	/**
+	 * Sums of squares above and below given limit, computed on first use
+	 * @param limit value (not squared)
+	 * @return cached statistics
+	 */
+	const ChannelStatistics & split(float limit) const;
+
+	/**
+	 * Make sure the sample data is not shared with other channels before
+	 * it is modified (copy-on-write).
+	 */
+	void     detach();
 
+	/**
+	 * Shared empty sample data for new and moved-from channels
+	 * @return empty sample buffer
+	 */
+	static const std::shared_ptr<SampleBuffer> & empty();
 };
+
+/**
+ * Audio channel with float samples, as used by the filters
+ */
+typedef BasicChannel<float>  Channel;
+
+/**
+ * Audio channel with compact 16 bit integer samples
+ */
+typedef BasicChannel<short>  ShortChannel;
+
 /**
  * Vector of channels as type for multiple channels.
  */
 typedef std::vector<Channel> Channels;
 
+/**
+ * Vector of channels with compact 16 bit integer samples
+ */
+typedef std::vector<ShortChannel> ShortChannels;
+
 /**
  * Unify samplerate and length of channels
  * @param channels to be unified
@@ -174,6 +410,6 @@ unsigned unifiedSamplerate(Channels &channels);
  * @param channels to be unified
  * @return length in number of channels
  */
-unsigned unifiedLength(Channels &channels);
+std::size_t unifiedLength(Channels &channels);
 
 #endif /* CHANNEL_H_ */
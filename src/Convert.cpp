@@ -0,0 +1,884 @@
+/**
+ * @file		Convert.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Vectorized conversion of interleaved sample data
+ */
+
+#include "Convert.h"
+#include "Log.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONVERT_X86
+#include <immintrin.h>
+#endif
+
+typedef void (*DeinterleaveKernel)(const float *,std::size_t,std::size_t,float,float * const *);
+typedef void (*DeinterleaveShortKernel)(const short *,std::size_t,std::size_t,float,float * const *);
+typedef void (*DeinterleaveIntKernel)(const int32_t *,std::size_t,std::size_t,float,float * const *);
+typedef void (*DeinterleaveDoubleKernel)(const double *,std::size_t,std::size_t,float,float * const *);
+typedef void (*InterleaveShortKernel)(const float * const *,std::size_t,std::size_t,short *);
+typedef void (*InterleaveIntKernel)(const float * const *,std::size_t,std::size_t,float,int32_t *);
+typedef void (*InterleaveFloatKernel)(const float * const *,std::size_t,std::size_t,float,float *);
+
+/**
+ * Largest float below 2^31, the limit of scaled 32 bit samples
+ */
+static const float intLimit=2147483520.f;
+
+/**
+ * Limit of 16 bit samples, symmetric around zero
+ */
+static const float shortLimit=32767.f;
+
+static void deinterleaveScalar(const float * in,std::size_t channels,std::size_t frames,
+		                       float scale,float * const * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		float * o=out[c];
+		const float * s=in+c;
+		for(std::size_t i=0;i<frames;i++,s+=channels)
+			o[i]=*s*scale;
+	}
+}
+
+static void deinterleaveShortScalar(const short * in,std::size_t channels,std::size_t frames,
+		                            float scale,float * const * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		float * o=out[c];
+		const short * s=in+c;
+		for(std::size_t i=0;i<frames;i++,s+=channels)
+			o[i]=float(*s)*scale;
+	}
+}
+
+static void deinterleaveShortMonoScalar(const short * in,std::size_t,std::size_t frames,
+		                                float scale,float * const * out)
+{
+	deinterleaveShortScalar(in,1,frames,scale,out);
+}
+
+static void deinterleaveShortStereoScalar(const short * in,std::size_t,std::size_t frames,
+		                                  float scale,float * const * out)
+{
+	deinterleaveShortScalar(in,2,frames,scale,out);
+}
+
+static void deinterleaveIntScalar(const int32_t * in,std::size_t channels,std::size_t frames,
+		                          float scale,float * const * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		float * o=out[c];
+		const int32_t * s=in+c;
+		for(std::size_t i=0;i<frames;i++,s+=channels)
+			o[i]=float(*s)*scale;
+	}
+}
+
+static void deinterleaveIntMonoScalar(const int32_t * in,std::size_t,std::size_t frames,
+		                              float scale,float * const * out)
+{
+	deinterleaveIntScalar(in,1,frames,scale,out);
+}
+
+static void deinterleaveIntStereoScalar(const int32_t * in,std::size_t,std::size_t frames,
+		                                float scale,float * const * out)
+{
+	deinterleaveIntScalar(in,2,frames,scale,out);
+}
+
+static void deinterleaveDoubleScalar(const double * in,std::size_t channels,std::size_t frames,
+		                             float scale,float * const * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		float * o=out[c];
+		const double * s=in+c;
+		for(std::size_t i=0;i<frames;i++,s+=channels)
+			o[i]=float(*s)*scale;
+	}
+}
+
+static void deinterleaveDoubleMonoScalar(const double * in,std::size_t,std::size_t frames,
+		                                 float scale,float * const * out)
+{
+	deinterleaveDoubleScalar(in,1,frames,scale,out);
+}
+
+static void deinterleaveMonoScalar(const float * in,std::size_t,std::size_t frames,
+		                           float scale,float * const * out)
+{
+	deinterleaveScalar(in,1,frames,scale,out);
+}
+
+static void deinterleaveStereoScalar(const float * in,std::size_t,std::size_t frames,
+		                             float scale,float * const * out)
+{
+	deinterleaveScalar(in,2,frames,scale,out);
+}
+
+static void deinterleaveQuadScalar(const float * in,std::size_t,std::size_t frames,
+		                           float scale,float * const * out)
+{
+	deinterleaveScalar(in,4,frames,scale,out);
+}
+
+static inline short saturateShort(float x)
+{
+	// same order of comparisons as the vector minimum and maximum
+	x=x>-shortLimit ? x : -shortLimit;
+	x=x<shortLimit ? x : shortLimit;
+	return short(x);
+}
+
+static inline int32_t saturateInt(float x)
+{
+	// same order of comparisons as the vector minimum and maximum
+	x=x>-intLimit ? x : -intLimit;
+	x=x<intLimit ? x : intLimit;
+	return int32_t(x);
+}
+
+static void interleaveShortScalar(const float * const * in,std::size_t channels,std::size_t frames,
+		                          short * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		const float * s=in[c];
+		short * o=out+c;
+		for(std::size_t i=0;i<frames;i++,o+=channels)
+			*o=saturateShort(s[i]);
+	}
+}
+
+static void interleaveShortMonoScalar(const float * const * in,std::size_t,std::size_t frames,
+		                              short * out)
+{
+	interleaveShortScalar(in,1,frames,out);
+}
+
+static void interleaveShortStereoScalar(const float * const * in,std::size_t,std::size_t frames,
+		                                short * out)
+{
+	interleaveShortScalar(in,2,frames,out);
+}
+
+static void interleaveIntScalar(const float * const * in,std::size_t channels,std::size_t frames,
+		                        float scale,int32_t * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		const float * s=in[c];
+		int32_t * o=out+c;
+		for(std::size_t i=0;i<frames;i++,o+=channels)
+			*o=saturateInt(s[i]*scale);
+	}
+}
+
+static void interleaveIntMonoScalar(const float * const * in,std::size_t,std::size_t frames,
+		                            float scale,int32_t * out)
+{
+	interleaveIntScalar(in,1,frames,scale,out);
+}
+
+static void interleaveIntStereoScalar(const float * const * in,std::size_t,std::size_t frames,
+		                              float scale,int32_t * out)
+{
+	interleaveIntScalar(in,2,frames,scale,out);
+}
+
+static void interleaveFloatScalar(const float * const * in,std::size_t channels,std::size_t frames,
+		                          float scale,float * out)
+{
+	for(std::size_t c=0;c<channels;c++)
+	{
+		const float * s=in[c];
+		float * o=out+c;
+		for(std::size_t i=0;i<frames;i++,o+=channels)
+			*o=s[i]*scale;
+	}
+}
+
+static void interleaveFloatMonoScalar(const float * const * in,std::size_t,std::size_t frames,
+		                              float scale,float * out)
+{
+	interleaveFloatScalar(in,1,frames,scale,out);
+}
+
+static void interleaveFloatStereoScalar(const float * const * in,std::size_t,std::size_t frames,
+		                                float scale,float * out)
+{
+	interleaveFloatScalar(in,2,frames,scale,out);
+}
+
+#ifdef CONVERT_X86
+
+__attribute__((target("sse2")))
+static void deinterleaveMonoSse2(const float * in,std::size_t,std::size_t frames,
+		                         float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+		_mm_storeu_ps(o+i,_mm_mul_ps(_mm_loadu_ps(in+i),f));
+	for(;i<frames;i++)
+		o[i]=in[i]*scale;
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveStereoSse2(const float * in,std::size_t,std::size_t frames,
+		                           float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * l=out[0];
+	float * r=out[1];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128 a=_mm_loadu_ps(in+2*i);
+		__m128 b=_mm_loadu_ps(in+2*i+4);
+		_mm_storeu_ps(l+i,_mm_mul_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0)),f));
+		_mm_storeu_ps(r+i,_mm_mul_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1)),f));
+	}
+	for(;i<frames;i++)
+	{
+		l[i]=in[2*i]*scale;
+		r[i]=in[2*i+1]*scale;
+	}
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveQuadSse2(const float * in,std::size_t,std::size_t frames,
+		                         float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128 a=_mm_loadu_ps(in+4*i);
+		__m128 b=_mm_loadu_ps(in+4*i+4);
+		__m128 c=_mm_loadu_ps(in+4*i+8);
+		__m128 d=_mm_loadu_ps(in+4*i+12);
+		_MM_TRANSPOSE4_PS(a,b,c,d);
+		_mm_storeu_ps(out[0]+i,_mm_mul_ps(a,f));
+		_mm_storeu_ps(out[1]+i,_mm_mul_ps(b,f));
+		_mm_storeu_ps(out[2]+i,_mm_mul_ps(c,f));
+		_mm_storeu_ps(out[3]+i,_mm_mul_ps(d,f));
+	}
+	for(;i<frames;i++)
+		for(unsigned c=0;c<4;c++)
+			out[c][i]=in[4*i+c]*scale;
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveMonoAvx2(const float * in,std::size_t,std::size_t frames,
+		                         float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+		_mm256_storeu_ps(o+i,_mm256_mul_ps(_mm256_loadu_ps(in+i),f));
+	for(;i<frames;i++)
+		o[i]=in[i]*scale;
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveStereoAvx2(const float * in,std::size_t,std::size_t frames,
+		                           float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * l=out[0];
+	float * r=out[1];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m256 a=_mm256_loadu_ps(in+2*i);
+		__m256 b=_mm256_loadu_ps(in+2*i+8);
+		// within each 128 bit lane: l0 l1 l4 l5 | l2 l3 l6 l7
+		__m256 even=_mm256_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0));
+		__m256 odd=_mm256_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1));
+		even=_mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(even),_MM_SHUFFLE(3,1,2,0)));
+		odd=_mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(odd),_MM_SHUFFLE(3,1,2,0)));
+		_mm256_storeu_ps(l+i,_mm256_mul_ps(even,f));
+		_mm256_storeu_ps(r+i,_mm256_mul_ps(odd,f));
+	}
+	for(;i<frames;i++)
+	{
+		l[i]=in[2*i]*scale;
+		r[i]=in[2*i+1]*scale;
+	}
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveShortMonoSse2(const short * in,std::size_t,std::size_t frames,
+		                              float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m128i x=_mm_loadu_si128((const __m128i *)(in+i));
+		// sign extend by placing the samples in the upper halves
+		__m128i lo=_mm_srai_epi32(_mm_unpacklo_epi16(x,x),16);
+		__m128i hi=_mm_srai_epi32(_mm_unpackhi_epi16(x,x),16);
+		_mm_storeu_ps(o+i,_mm_mul_ps(_mm_cvtepi32_ps(lo),f));
+		_mm_storeu_ps(o+i+4,_mm_mul_ps(_mm_cvtepi32_ps(hi),f));
+	}
+	for(;i<frames;i++)
+		o[i]=float(in[i])*scale;
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveShortStereoSse2(const short * in,std::size_t,std::size_t frames,
+		                                float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * l=out[0];
+	float * r=out[1];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		// each 32 bit lane holds the left sample below the right sample
+		__m128i x=_mm_loadu_si128((const __m128i *)(in+2*i));
+		__m128i left=_mm_srai_epi32(_mm_slli_epi32(x,16),16);
+		__m128i right=_mm_srai_epi32(x,16);
+		_mm_storeu_ps(l+i,_mm_mul_ps(_mm_cvtepi32_ps(left),f));
+		_mm_storeu_ps(r+i,_mm_mul_ps(_mm_cvtepi32_ps(right),f));
+	}
+	for(;i<frames;i++)
+	{
+		l[i]=float(in[2*i])*scale;
+		r[i]=float(in[2*i+1])*scale;
+	}
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveShortMonoAvx2(const short * in,std::size_t,std::size_t frames,
+		                              float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m256i x=_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in+i)));
+		_mm256_storeu_ps(o+i,_mm256_mul_ps(_mm256_cvtepi32_ps(x),f));
+	}
+	for(;i<frames;i++)
+		o[i]=float(in[i])*scale;
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveShortStereoAvx2(const short * in,std::size_t,std::size_t frames,
+		                                float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * l=out[0];
+	float * r=out[1];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m256i x=_mm256_loadu_si256((const __m256i *)(in+2*i));
+		__m256i left=_mm256_srai_epi32(_mm256_slli_epi32(x,16),16);
+		__m256i right=_mm256_srai_epi32(x,16);
+		_mm256_storeu_ps(l+i,_mm256_mul_ps(_mm256_cvtepi32_ps(left),f));
+		_mm256_storeu_ps(r+i,_mm256_mul_ps(_mm256_cvtepi32_ps(right),f));
+	}
+	for(;i<frames;i++)
+	{
+		l[i]=float(in[2*i])*scale;
+		r[i]=float(in[2*i+1])*scale;
+	}
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveIntMonoSse2(const int32_t * in,std::size_t,std::size_t frames,
+		                            float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128i x=_mm_loadu_si128((const __m128i *)(in+i));
+		_mm_storeu_ps(o+i,_mm_mul_ps(_mm_cvtepi32_ps(x),f));
+	}
+	for(;i<frames;i++)
+		o[i]=float(in[i])*scale;
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveIntStereoSse2(const int32_t * in,std::size_t,std::size_t frames,
+		                              float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * l=out[0];
+	float * r=out[1];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		// shuffle the integer lanes as floats before converting them
+		__m128 a=_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(in+2*i)));
+		__m128 b=_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(in+2*i+4)));
+		__m128i left=_mm_castps_si128(_mm_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0)));
+		__m128i right=_mm_castps_si128(_mm_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1)));
+		_mm_storeu_ps(l+i,_mm_mul_ps(_mm_cvtepi32_ps(left),f));
+		_mm_storeu_ps(r+i,_mm_mul_ps(_mm_cvtepi32_ps(right),f));
+	}
+	for(;i<frames;i++)
+	{
+		l[i]=float(in[2*i])*scale;
+		r[i]=float(in[2*i+1])*scale;
+	}
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveDoubleMonoSse2(const double * in,std::size_t,std::size_t frames,
+		                               float scale,float * const * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128 a=_mm_cvtpd_ps(_mm_loadu_pd(in+i));
+		__m128 b=_mm_cvtpd_ps(_mm_loadu_pd(in+i+2));
+		_mm_storeu_ps(o+i,_mm_mul_ps(_mm_movelh_ps(a,b),f));
+	}
+	for(;i<frames;i++)
+		o[i]=float(in[i])*scale;
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveIntMonoAvx2(const int32_t * in,std::size_t,std::size_t frames,
+		                            float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m256i x=_mm256_loadu_si256((const __m256i *)(in+i));
+		_mm256_storeu_ps(o+i,_mm256_mul_ps(_mm256_cvtepi32_ps(x),f));
+	}
+	for(;i<frames;i++)
+		o[i]=float(in[i])*scale;
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveIntStereoAvx2(const int32_t * in,std::size_t,std::size_t frames,
+		                              float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * l=out[0];
+	float * r=out[1];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m256 a=_mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)(in+2*i)));
+		__m256 b=_mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)(in+2*i+8)));
+		// same lane order as the float kernel
+		__m256 even=_mm256_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0));
+		__m256 odd=_mm256_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1));
+		__m256i left=_mm256_permute4x64_epi64(_mm256_castps_si256(even),_MM_SHUFFLE(3,1,2,0));
+		__m256i right=_mm256_permute4x64_epi64(_mm256_castps_si256(odd),_MM_SHUFFLE(3,1,2,0));
+		_mm256_storeu_ps(l+i,_mm256_mul_ps(_mm256_cvtepi32_ps(left),f));
+		_mm256_storeu_ps(r+i,_mm256_mul_ps(_mm256_cvtepi32_ps(right),f));
+	}
+	for(;i<frames;i++)
+	{
+		l[i]=float(in[2*i])*scale;
+		r[i]=float(in[2*i+1])*scale;
+	}
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveDoubleMonoAvx2(const double * in,std::size_t,std::size_t frames,
+		                               float scale,float * const * out)
+{
+	const __m256 f=_mm256_set1_ps(scale);
+	float * o=out[0];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m128 a=_mm256_cvtpd_ps(_mm256_loadu_pd(in+i));
+		__m128 b=_mm256_cvtpd_ps(_mm256_loadu_pd(in+i+4));
+		_mm256_storeu_ps(o+i,_mm256_mul_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(a),b,1),f));
+	}
+	for(;i<frames;i++)
+		o[i]=float(in[i])*scale;
+}
+
+__attribute__((target("sse2")))
+static inline __m128i saturateShortSse2(__m128 x)
+{
+	// clamped before the conversion, which is undefined out of range
+	x=_mm_max_ps(x,_mm_set1_ps(-shortLimit));
+	return _mm_cvttps_epi32(_mm_min_ps(x,_mm_set1_ps(shortLimit)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i saturateShortAvx2(__m256 x)
+{
+	x=_mm256_max_ps(x,_mm256_set1_ps(-shortLimit));
+	return _mm256_cvttps_epi32(_mm256_min_ps(x,_mm256_set1_ps(shortLimit)));
+}
+
+__attribute__((target("sse2")))
+static void interleaveShortMonoSse2(const float * const * in,std::size_t,std::size_t frames,
+		                            short * out)
+{
+	const float * s=in[0];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m128i a=saturateShortSse2(_mm_loadu_ps(s+i));
+		__m128i b=saturateShortSse2(_mm_loadu_ps(s+i+4));
+		_mm_storeu_si128((__m128i *)(out+i),_mm_packs_epi32(a,b));
+	}
+	for(;i<frames;i++)
+		out[i]=saturateShort(s[i]);
+}
+
+__attribute__((target("sse2")))
+static void interleaveShortStereoSse2(const float * const * in,std::size_t,std::size_t frames,
+		                              short * out)
+{
+	const float * l=in[0];
+	const float * r=in[1];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128i a=saturateShortSse2(_mm_loadu_ps(l+i));
+		__m128i b=saturateShortSse2(_mm_loadu_ps(r+i));
+		__m128i x=_mm_packs_epi32(_mm_unpacklo_epi32(a,b),_mm_unpackhi_epi32(a,b));
+		_mm_storeu_si128((__m128i *)(out+2*i),x);
+	}
+	for(;i<frames;i++)
+	{
+		out[2*i]=saturateShort(l[i]);
+		out[2*i+1]=saturateShort(r[i]);
+	}
+}
+
+__attribute__((target("avx2")))
+static void interleaveShortMonoAvx2(const float * const * in,std::size_t,std::size_t frames,
+		                            short * out)
+{
+	const float * s=in[0];
+	std::size_t i=0;
+	for(;i+16<=frames;i+=16)
+	{
+		__m256i a=saturateShortAvx2(_mm256_loadu_ps(s+i));
+		__m256i b=saturateShortAvx2(_mm256_loadu_ps(s+i+8));
+		// packing works within each 128 bit lane: a0-3 b0-3 | a4-7 b4-7
+		__m256i x=_mm256_permute4x64_epi64(_mm256_packs_epi32(a,b),_MM_SHUFFLE(3,1,2,0));
+		_mm256_storeu_si256((__m256i *)(out+i),x);
+	}
+	for(;i<frames;i++)
+		out[i]=saturateShort(s[i]);
+}
+
+__attribute__((target("avx2")))
+static void interleaveShortStereoAvx2(const float * const * in,std::size_t,std::size_t frames,
+		                              short * out)
+{
+	const float * l=in[0];
+	const float * r=in[1];
+	std::size_t i=0;
+	for(;i+8<=frames;i+=8)
+	{
+		__m256i a=saturateShortAvx2(_mm256_loadu_ps(l+i));
+		__m256i b=saturateShortAvx2(_mm256_loadu_ps(r+i));
+		// the lane-wise unpacking and packing keep the frames in order
+		__m256i x=_mm256_packs_epi32(_mm256_unpacklo_epi32(a,b),_mm256_unpackhi_epi32(a,b));
+		_mm256_storeu_si256((__m256i *)(out+2*i),x);
+	}
+	for(;i<frames;i++)
+	{
+		out[2*i]=saturateShort(l[i]);
+		out[2*i+1]=saturateShort(r[i]);
+	}
+}
+
+__attribute__((target("sse2")))
+static inline __m128i saturateIntSse2(__m128 x,__m128 scale)
+{
+	const __m128 limit=_mm_set1_ps(intLimit);
+	x=_mm_max_ps(_mm_mul_ps(x,scale),_mm_set1_ps(-intLimit));
+	return _mm_cvttps_epi32(_mm_min_ps(x,limit));
+}
+
+__attribute__((target("sse2")))
+static void interleaveIntMonoSse2(const float * const * in,std::size_t,std::size_t frames,
+		                          float scale,int32_t * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	const float * s=in[0];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+		_mm_storeu_si128((__m128i *)(out+i),saturateIntSse2(_mm_loadu_ps(s+i),f));
+	for(;i<frames;i++)
+		out[i]=saturateInt(s[i]*scale);
+}
+
+__attribute__((target("sse2")))
+static void interleaveIntStereoSse2(const float * const * in,std::size_t,std::size_t frames,
+		                            float scale,int32_t * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	const float * l=in[0];
+	const float * r=in[1];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128i a=saturateIntSse2(_mm_loadu_ps(l+i),f);
+		__m128i b=saturateIntSse2(_mm_loadu_ps(r+i),f);
+		_mm_storeu_si128((__m128i *)(out+2*i),_mm_unpacklo_epi32(a,b));
+		_mm_storeu_si128((__m128i *)(out+2*i+4),_mm_unpackhi_epi32(a,b));
+	}
+	for(;i<frames;i++)
+	{
+		out[2*i]=saturateInt(l[i]*scale);
+		out[2*i+1]=saturateInt(r[i]*scale);
+	}
+}
+
+__attribute__((target("sse2")))
+static void interleaveFloatMonoSse2(const float * const * in,std::size_t,std::size_t frames,
+		                            float scale,float * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	const float * s=in[0];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+		_mm_storeu_ps(out+i,_mm_mul_ps(_mm_loadu_ps(s+i),f));
+	for(;i<frames;i++)
+		out[i]=s[i]*scale;
+}
+
+__attribute__((target("sse2")))
+static void interleaveFloatStereoSse2(const float * const * in,std::size_t,std::size_t frames,
+		                              float scale,float * out)
+{
+	const __m128 f=_mm_set1_ps(scale);
+	const float * l=in[0];
+	const float * r=in[1];
+	std::size_t i=0;
+	for(;i+4<=frames;i+=4)
+	{
+		__m128 a=_mm_mul_ps(_mm_loadu_ps(l+i),f);
+		__m128 b=_mm_mul_ps(_mm_loadu_ps(r+i),f);
+		_mm_storeu_ps(out+2*i,_mm_unpacklo_ps(a,b));
+		_mm_storeu_ps(out+2*i+4,_mm_unpackhi_ps(a,b));
+	}
+	for(;i<frames;i++)
+	{
+		out[2*i]=l[i]*scale;
+		out[2*i+1]=r[i]*scale;
+	}
+}
+
+#endif
+
+/**
+ * Kernels for the processor in use, selected on first use
+ */
+struct ConvertKernels
+{
+	DeinterleaveKernel mono;
+	DeinterleaveKernel stereo;
+	DeinterleaveKernel quad;
+	DeinterleaveShortKernel shortMono;
+	DeinterleaveShortKernel shortStereo;
+	DeinterleaveIntKernel intMono;
+	DeinterleaveIntKernel intStereo;
+	DeinterleaveDoubleKernel doubleMono;
+	InterleaveShortKernel toShortMono;
+	InterleaveShortKernel toShortStereo;
+	InterleaveIntKernel toIntMono;
+	InterleaveIntKernel toIntStereo;
+	InterleaveFloatKernel toFloatMono;
+	InterleaveFloatKernel toFloatStereo;
+	const char *       name;
+
+	ConvertKernels() : mono(deinterleaveMonoScalar), stereo(deinterleaveStereoScalar),
+			           quad(deinterleaveQuadScalar), shortMono(deinterleaveShortMonoScalar),
+			           shortStereo(deinterleaveShortStereoScalar), intMono(deinterleaveIntMonoScalar),
+			           intStereo(deinterleaveIntStereoScalar), doubleMono(deinterleaveDoubleMonoScalar),
+			           toShortMono(interleaveShortMonoScalar), toShortStereo(interleaveShortStereoScalar),
+			           toIntMono(interleaveIntMonoScalar), toIntStereo(interleaveIntStereoScalar),
+			           toFloatMono(interleaveFloatMonoScalar), toFloatStereo(interleaveFloatStereoScalar),
+			           name("scalar")
+	{
+#ifdef CONVERT_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2"))
+		{
+			mono=deinterleaveMonoAvx2;
+			stereo=deinterleaveStereoAvx2;
+			quad=deinterleaveQuadSse2;
+			shortMono=deinterleaveShortMonoAvx2;
+			shortStereo=deinterleaveShortStereoAvx2;
+			intMono=deinterleaveIntMonoAvx2;
+			intStereo=deinterleaveIntStereoAvx2;
+			doubleMono=deinterleaveDoubleMonoAvx2;
+			toShortMono=interleaveShortMonoAvx2;
+			toShortStereo=interleaveShortStereoAvx2;
+			toIntMono=interleaveIntMonoSse2;
+			toIntStereo=interleaveIntStereoSse2;
+			toFloatMono=interleaveFloatMonoSse2;
+			toFloatStereo=interleaveFloatStereoSse2;
+			name="avx2";
+		} else
+		if(__builtin_cpu_supports("sse2"))
+		{
+			mono=deinterleaveMonoSse2;
+			stereo=deinterleaveStereoSse2;
+			quad=deinterleaveQuadSse2;
+			shortMono=deinterleaveShortMonoSse2;
+			shortStereo=deinterleaveShortStereoSse2;
+			intMono=deinterleaveIntMonoSse2;
+			intStereo=deinterleaveIntStereoSse2;
+			doubleMono=deinterleaveDoubleMonoSse2;
+			toShortMono=interleaveShortMonoSse2;
+			toShortStereo=interleaveShortStereoSse2;
+			toIntMono=interleaveIntMonoSse2;
+			toIntStereo=interleaveIntStereoSse2;
+			toFloatMono=interleaveFloatMonoSse2;
+			toFloatStereo=interleaveFloatStereoSse2;
+			name="sse2";
+		}
+#endif
+		LOG(logDEBUG) << "Using " << name << " conversion kernels" << std::endl;
+	}
+};
+
+static const ConvertKernels & kernels()
+{
+	static ConvertKernels k;
+	return k;
+}
+
+void Convert::deinterleave(const float * in,unsigned channels,std::size_t frames,
+		                   float scale,float * const * out)
+{
+	switch(channels)
+	{
+	case 1:
+		kernels().mono(in,1,frames,scale,out);
+		break;
+	case 2:
+		kernels().stereo(in,2,frames,scale,out);
+		break;
+	case 4:
+		kernels().quad(in,4,frames,scale,out);
+		break;
+	default:
+		deinterleaveScalar(in,channels,frames,scale,out);
+		break;
+	}
+}
+
+void Convert::deinterleave(const short * in,unsigned channels,std::size_t frames,
+		                   float scale,float * const * out)
+{
+	switch(channels)
+	{
+	case 1:
+		kernels().shortMono(in,1,frames,scale,out);
+		break;
+	case 2:
+		kernels().shortStereo(in,2,frames,scale,out);
+		break;
+	default:
+		deinterleaveShortScalar(in,channels,frames,scale,out);
+		break;
+	}
+}
+
+void Convert::deinterleave(const int32_t * in,unsigned channels,std::size_t frames,
+		                   float scale,float * const * out)
+{
+	switch(channels)
+	{
+	case 1:
+		kernels().intMono(in,1,frames,scale,out);
+		break;
+	case 2:
+		kernels().intStereo(in,2,frames,scale,out);
+		break;
+	default:
+		deinterleaveIntScalar(in,channels,frames,scale,out);
+		break;
+	}
+}
+
+void Convert::deinterleave(const double * in,unsigned channels,std::size_t frames,
+		                   float scale,float * const * out)
+{
+	if(channels==1)
+		kernels().doubleMono(in,1,frames,scale,out);
+	else
+		deinterleaveDoubleScalar(in,channels,frames,scale,out);
+}
+
+void Convert::interleave(const float * const * in,unsigned channels,std::size_t frames,
+		                 short * out)
+{
+	switch(channels)
+	{
+	case 1:
+		kernels().toShortMono(in,1,frames,out);
+		break;
+	case 2:
+		kernels().toShortStereo(in,2,frames,out);
+		break;
+	default:
+		interleaveShortScalar(in,channels,frames,out);
+		break;
+	}
+}
+
+void Convert::interleave(const float * const * in,unsigned channels,std::size_t frames,
+		                 float scale,int32_t * out)
+{
+	switch(channels)
+	{
+	case 1:
+		kernels().toIntMono(in,1,frames,scale,out);
+		break;
+	case 2:
+		kernels().toIntStereo(in,2,frames,scale,out);
+		break;
+	default:
+		interleaveIntScalar(in,channels,frames,scale,out);
+		break;
+	}
+}
+
+void Convert::interleave(const float * const * in,unsigned channels,std::size_t frames,
+		                 float scale,float * out)
+{
+	switch(channels)
+	{
+	case 1:
+		kernels().toFloatMono(in,1,frames,scale,out);
+		break;
+	case 2:
+		kernels().toFloatStereo(in,2,frames,scale,out);
+		break;
+	default:
+		interleaveFloatScalar(in,channels,frames,scale,out);
+		break;
+	}
+}
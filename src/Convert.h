@@ -0,0 +1,121 @@
+/**
+ * @file		Convert.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Vectorized conversion of interleaved sample data
+ */
+
+#ifndef CONVERT_H_
+#define CONVERT_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @brief Conversion kernels between interleaved frames and channels
+ *
+ * Decoders deliver interleaved frames, while the channels hold the samples
+ * of each channel consecutively. The float kernels for one, two and four
+ * channels, the 16 and 32 bit integer kernels for one and two channels
+ * and the double kernel for one channel are vectorized with SSE2 or AVX2,
+ * chosen at run time depending on the capabilities of the processor, other
+ * channel counts are converted by a scalar loop. All variants give
+ * identical results.
+ *
+ * Planar data, where each channel is stored in a plane of its own, is
+ * converted plane by plane as a single channel.
+ *
+ * For writing, the channels are interleaved into frames again. The 16 bit
+ * kernels for one and two channels are vectorized with SSE2 or AVX2, the
+ * 32 bit integer and float kernels for one and two channels with SSE2.
+ * Integer targets saturate instead of wrapping around.
+ */
+class Convert
+{
+public:
+	/**
+	 * Split interleaved frames into channels and scale the samples
+	 * @param in       interleaved samples of all channels
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param scale    factor applied to each sample
+	 * @param out      target of the samples of each channel
+	 */
+	static void deinterleave(const float * in,unsigned channels,std::size_t frames,
+			                 float scale,float * const * out);
+
+	/**
+	 * Split interleaved 16 bit frames into float channels and scale the
+	 * samples
+	 * @param in       interleaved samples of all channels
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param scale    factor applied to each sample
+	 * @param out      target of the samples of each channel
+	 */
+	static void deinterleave(const short * in,unsigned channels,std::size_t frames,
+			                 float scale,float * const * out);
+
+	/**
+	 * Split interleaved 32 bit frames into float channels and scale the
+	 * samples
+	 * @param in       interleaved samples of all channels
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param scale    factor applied to each sample
+	 * @param out      target of the samples of each channel
+	 */
+	static void deinterleave(const int32_t * in,unsigned channels,std::size_t frames,
+			                 float scale,float * const * out);
+
+	/**
+	 * Split interleaved double frames into float channels and scale the
+	 * samples after rounding them to float
+	 * @param in       interleaved samples of all channels
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param scale    factor applied to each sample
+	 * @param out      target of the samples of each channel
+	 */
+	static void deinterleave(const double * in,unsigned channels,std::size_t frames,
+			                 float scale,float * const * out);
+
+	/**
+	 * Interleave channels into 16 bit frames. The samples are truncated
+	 * and saturated to the range of [-32767,32767].
+	 * @param in       samples of each channel
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param out      interleaved samples of all channels
+	 */
+	static void interleave(const float * const * in,unsigned channels,std::size_t frames,
+			               short * out);
+
+	/**
+	 * Interleave channels into 32 bit frames after scaling the samples.
+	 * The scaled samples are saturated to the range of 32 bit integers and
+	 * truncated.
+	 * @param in       samples of each channel
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param scale    factor applied to each sample
+	 * @param out      interleaved samples of all channels
+	 */
+	static void interleave(const float * const * in,unsigned channels,std::size_t frames,
+			               float scale,int32_t * out);
+
+	/**
+	 * Interleave channels into float frames after scaling the samples
+	 * @param in       samples of each channel
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @param scale    factor applied to each sample
+	 * @param out      interleaved samples of all channels
+	 */
+	static void interleave(const float * const * in,unsigned channels,std::size_t frames,
+			               float scale,float * out);
+};
+
+#endif /* CONVERT_H_ */
@@ -93,13 +93,16 @@ void CrosstalkFilter::prepareVectors()
 
 
 		double sum=0;
+		const long w=workWindow*10;
+		PaddedView<float> d=downsample[i].padded(w);
+		Span<float> a=activity[i].span();
 
-		for(unsigned j=0;j<downsample[i].size();j++)
+		for(std::size_t j=0;j<a.size();j++)
 		{
-			sum+=downsample[i][j+workWindow*10]-downsample[i][j-workWindow*10];
+			sum+=d[j+w]-d[j-w];
 			if(sum<0)
 				sum=0;
-			activity[i][j]=(sum/workWindow/2/10)/l2downnorm[i]*1000;
+			a[j]=(sum/workWindow/2/10)/l2downnorm[i]*1000;
 		}
 	}
 }
@@ -122,7 +125,7 @@ void CrosstalkFilter::analyze2()
 			{
 				double sum=0;
 				double n1=0,n2=0;
-				for(unsigned l=0;l<downsample[i].size();l++)
+				for(std::size_t l=0;l<downsample[i].size();l++)
 				{
 					sum+=downsample[i][l]*downsample[j][l+k];
 					n1+=downsample[i][l];
@@ -145,7 +148,7 @@ void CrosstalkFilter::analyze2()
 		LOG(logDEBUG) << "Analyzing " << downsample[i].size() << " windows." << std::endl;
 		int count=0;
 		int shiftsum=0;
-		for(unsigned j=0;j<downsample[i].size();j++)
+		for(std::size_t j=0;j<downsample[i].size();j++)
 		{
 			double mute=1;
 
@@ -217,6 +220,15 @@ void CrosstalkFilter::analyze2()
 void CrosstalkFilter::analyze()
 {
 	LOG(logDEBUG) << "We have " << channels.size() << " channels." << std::endl;
+
+	const int maxDelta=20;
+	unsigned halo=workWindow+2*maxDelta;
+	if(maxShift>halo)
+		halo=maxShift;
+	std::vector<PaddedView<float> > ds(channels.size());
+	for(unsigned i=0;i<channels.size();i++)
+		ds[i]=downsample[i].padded(halo);
+
 	std::vector<std::vector<unsigned> > shift(channels.size());
 	for(unsigned i=0;i<channels.size();i++)
 	{
@@ -230,9 +242,11 @@ void CrosstalkFilter::analyze()
 			for(unsigned k=minShift;k<maxShift;k++)
 			{
 				double sum=0;
-				for(unsigned l=0;l<downsample[i].size();l++)
+				const PaddedView<float> & di=ds[i];
+				const PaddedView<float> & dj=ds[j];
+				for(long l=0;l<(long)di.size();l++)
 				{
-					sum+=downsample[i][l]*downsample[j][l-k];
+					sum+=di[l]*dj[l-k];
 				}
 				sum/=(channels[i].size());
 				sum=fabs(sum);
@@ -251,16 +265,17 @@ void CrosstalkFilter::analyze()
 	for(unsigned i=0;i<channels.size();i++)
 	{
 		LOG(logDEBUG) << i << ": Analyzing " << downsample[i].size() << " windows." << std::endl;
-		for(unsigned l=0;l<muteFactor[i].size();l++)
-			muteFactor[i][l]=0;
+		Span<float> mf=muteFactor[i].span();
+		for(std::size_t l=0;l<mf.size();l++)
+			mf[l]=0;
 
 		for(unsigned j=0;j<channels.size();j++)
 		{
 			double skpIn=0;
 			double skpOut=0;
 			double ni2=0,nj2=0,nr=0;
-			int    deltaIn=20;
-			int    deltaOut=20;
+			int    deltaIn=maxDelta;
+			int    deltaOut=maxDelta;
 
 			if(i!=j)
 			{
@@ -286,23 +301,27 @@ void CrosstalkFilter::analyze()
 					njsOut2[v+deltaOut]=0;
 				}
 
-				for(int l=-workWindow;l<0;l++)
+				const PaddedView<float> & di=ds[i];
+				const PaddedView<float> & dj=ds[j];
+				const long w=workWindow;
+
+				for(long l=-w;l<0;l++)
 				{
 					for(int v=-deltaIn;v<=deltaIn;v++)
 					{
-						skpsIn[v+deltaIn]+=downsample[i][l+workWindow]*downsample[j][l+workWindow-sIn+v];
-						njsIn2[v+deltaIn]+=sqr(downsample[j][l+workWindow-sIn+v]);
+						skpsIn[v+deltaIn]+=di[l+w]*dj[l+w-(long)sIn+v];
+						njsIn2[v+deltaIn]+=sqr(dj[l+w-(long)sIn+v]);
 					}
 					for(int v=-deltaOut;v<=deltaOut;v++)
 					{
-						skpsOut[v+deltaOut]+=downsample[i][l+workWindow]*downsample[j][l+workWindow+sOut+v];
-						njsOut2[v+deltaOut]+=sqr(downsample[j][l+workWindow+sOut+v]);
+						skpsOut[v+deltaOut]+=di[l+w]*dj[l+w+(long)sOut+v];
+						njsOut2[v+deltaOut]+=sqr(dj[l+w+(long)sOut+v]);
 					}
-					ni2+=sqr(downsample[i][l+workWindow]);
+					ni2+=sqr(di[l+w]);
 				}
 
 
-				for(unsigned l=0;l<downsample[i].size();l++)
+				for(long l=0;l<(long)mf.size();l++)
 				{
 					int vIn=0;
 					int vOut=0;
@@ -311,36 +330,36 @@ void CrosstalkFilter::analyze()
 					skpOut=0;
 					for(int v=-deltaIn;v<=deltaIn;v++)
 					{
-						skpsIn[v+deltaIn]+=downsample[i][l+workWindow]*downsample[j][l+workWindow-sIn+v];
-						skpsIn[v+deltaIn]-=downsample[i][l-workWindow]*downsample[j][l-workWindow-sIn+v];
+						skpsIn[v+deltaIn]+=di[l+w]*dj[l+w-(long)sIn+v];
+						skpsIn[v+deltaIn]-=di[l-w]*dj[l-w-(long)sIn+v];
 						if(fabs(skpsIn[v+deltaIn])>skpIn)
 						{
 							skpIn=fabs(skpsIn[v+deltaIn]);
 							vIn=v+deltaIn;
 						}
-						njsIn2[v+deltaIn]+=sqr(downsample[j][l+workWindow-sIn+v]);
-						njsIn2[v+deltaIn]-=sqr(downsample[j][l-workWindow-sIn+v]);
+						njsIn2[v+deltaIn]+=sqr(dj[l+w-(long)sIn+v]);
+						njsIn2[v+deltaIn]-=sqr(dj[l-w-(long)sIn+v]);
 						if(njsIn2[v+deltaIn]<0)
 							njsIn2[v+deltaIn]=0;
 					}
 					for(int v=-deltaOut;v<=deltaOut;v++)
 					{
-						skpsOut[v+deltaOut]+=downsample[i][l+workWindow]*downsample[j][l+workWindow+sOut+v];
-						skpsOut[v+deltaOut]-=downsample[i][l-workWindow]*downsample[j][l-workWindow+sOut+v];
+						skpsOut[v+deltaOut]+=di[l+w]*dj[l+w+(long)sOut+v];
+						skpsOut[v+deltaOut]-=di[l-w]*dj[l-w+(long)sOut+v];
 						if(fabs(skpsOut[v+deltaOut])>skpOut)
 						{
 							skpOut=fabs(skpsOut[v+deltaOut]);
 							vOut=v+deltaOut;
 						}
-						njsOut2[v+deltaOut]+=sqr(downsample[j][l+workWindow+sOut+v]);
-						njsOut2[v+deltaOut]-=sqr(downsample[j][l-workWindow+sOut+v]);
+						njsOut2[v+deltaOut]+=sqr(dj[l+w+(long)sOut+v]);
+						njsOut2[v+deltaOut]-=sqr(dj[l-w+(long)sOut+v]);
 						if(njsOut2[v+deltaOut]<0)
 							njsOut2[v+deltaOut]=0;
 					}
 
 
-					ni2+=sqr(downsample[i][l+workWindow]);
-					ni2-=sqr(downsample[i][l-workWindow]);
+					ni2+=sqr(di[l+w]);
+					ni2-=sqr(di[l-w]);
 
 					if(ni2<0)
 						ni2=0;
@@ -358,16 +377,16 @@ void CrosstalkFilter::analyze()
 						nr=(nr+sqr(skpOut)/njsOut2[vOut]);
 					}
 
-					if(!(muteFactor[i][l]==muteFactor[i][l]))
+					if(!(mf[l]==mf[l]))
 					{
 						LOG(logERROR) << "nan in factor! " << i << " " << l << " " << nj2 << " " << ni2 << " " << nr << " " <<skpIn << std::endl;
 						return;
 					}
 
 					if(ni2>0 && nr>0)
-						muteFactor[i][l]+=(sqrt(ni2)-sqrt(nr))/sqrt(ni2);
+						mf[l]+=(sqrt(ni2)-sqrt(nr))/sqrt(ni2);
 
-					if(!(muteFactor[i][l]==muteFactor[i][l]))
+					if(!(mf[l]==mf[l]))
 					{
 						LOG(logERROR) << "nan in factor! " << i << " " << l << " " << nj2 << " " << ni2 << " " << nr << " " <<skpIn << " " << vIn << " " << njsIn2[vIn] << std::endl;
 						return;
@@ -387,7 +406,7 @@ void CrosstalkFilter::save(std::string name)
 	for(unsigned c=0;c<muteFactor.size();c++)
 	{
 		amp[c]=muteFactor[c];
-		for(unsigned i=0;i<amp[c].size();i++)
+		for(std::size_t i=0;i<amp[c].size();i++)
 			amp[c][i]*=32000;
 	}
 	Wave::save(name,amp);
@@ -396,9 +415,9 @@ void CrosstalkFilter::save(std::string name)
 /** CrosstalkFilter mute channels
  * 	applies mute filter to previously given channels
  */
-void CrosstalkFilter::mute()
+void CrosstalkFilter::normalizeFactors()
 {
-	for(unsigned j=0;j<muteFactor[0].size();j++)
+	for(std::size_t j=0;j<muteFactor[0].size();j++)
 	{
 		float max=-1;
 		float min=1;
@@ -426,18 +445,49 @@ void CrosstalkFilter::mute()
 			}
 		}
 	}
+}
+
+void CrosstalkFilter::mute(Pipeline &aPipeline)
+{
+	normalizeFactors();
 
 	for(unsigned c=0;c<channels.size();c++)
 	{
-		int size=channels[c].size();
-		int reds=muteFactor[c].size();
-		int down=size/reds;
+		std::size_t size=channels[c].size();
+		std::size_t reds=muteFactor[c].size();
+		std::size_t down=size/reds;
+
+		Channel gain(channels[c].samplerate(),size);
+		Span<float> g=gain.span();
+		Span<const float> mf=muteFactor[c].view();
+
+		for(std::size_t j=0;j<size;j++)
+		{
+			std::size_t m=j/down;
+			g[j]=(m<reds)?mf[m]:0;
+		}
+		aPipeline.gain(c,gain);
+	}
+}
+
+void CrosstalkFilter::mute()
+{
+	normalizeFactors();
+
+	for(unsigned c=0;c<channels.size();c++)
+	{
+		std::size_t size=channels[c].size();
+		std::size_t reds=muteFactor[c].size();
+		std::size_t down=size/reds;
+
+		Span<float> s=channels[c].span();
+		Span<const float> mf=muteFactor[c].view();
 
-		for(unsigned j=0;j<channels[c].size();j++)
+		for(std::size_t j=0;j<s.size();j++)
 		{
-			int   m=j/down;
-			channels[c][j]*=muteFactor[c][m];
-			if(!(channels[c][j]==channels[c][j]))
+			std::size_t m=j/down;
+			s[j]*=(m<reds)?mf[m]:0;
+			if(!(s[j]==s[j]))
 			{
 				LOG(logERROR) << "nan in channels! " << c << " " << j << std::endl;
 			}
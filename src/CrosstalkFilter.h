@@ -13,6 +13,7 @@
 #include <vector>
 #include <string>
 #include "Channel.h"
+#include "Pipeline.h"
 
 /**
  * @brief The CrosstalkFilter tries to identify time-delayed crosstalk of each channel in other channels
@@ -85,12 +86,24 @@ public:
 	void	save(std::string);
 	void	mute();
 
+	/**
+	 * 		Add the muting factors as gain curves to a pipeline on the
+	 * 		channels of this filter instead of applying them, see mute()
+	 * 		\param aPipeline	pipeline on the audio channels
+	 */
+	void	mute(Pipeline &aPipeline);
+
 private:
 	template<class T>
 	static T sqr(const T&a){return a*a;}
 
 	void 	prepareVectors();
 
+	/**
+	 * 		Turn the analyzed ratios into muting factors between 0 and 1
+	 */
+	void	normalizeFactors();
+
 
 };
 
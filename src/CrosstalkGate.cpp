@@ -14,9 +14,20 @@
 
 void CrosstalkGate::gate(Channels &channels,unsigned downsampleLevel,double windowsec,double mixsec)
 {
-	if(channels.size()==0)
+	Pipeline pipeline(channels);
+	gate(pipeline,downsampleLevel,windowsec,mixsec);
+	pipeline.apply();
+}
+
+void CrosstalkGate::gate(Pipeline &pipeline,unsigned downsampleLevel,double windowsec,double mixsec)
+{
+	if(pipeline.channels()==0)
 		return;
 
+	if(pipeline.pending())
+		pipeline.apply();
+	Channels &channels=pipeline.input();
+
 	unsigned workWindow=windowsec*channels[0].samplerate()/downsampleLevel;
 	unsigned mixWindow=mixsec*channels[0].samplerate();
 
@@ -44,18 +55,21 @@ void CrosstalkGate::gate(Channels &channels,unsigned downsampleLevel,double wind
 
 
 		double sum=0;
+		const long w=workWindow;
+		PaddedView<float> d=downsample[i].padded(workWindow);
+		Span<float> a=activity[i].span();
 		
 		for(unsigned j=0;j<workWindow;j++)
 		{
-			sum+=downsample[i][j];
+			sum+=d[j];
 		}
 		
-		for(unsigned j=0;j<downsample[i].size();j++)
+		for(unsigned j=0;j<a.size();j++)
 		{
-			sum+=downsample[i][j+workWindow]-downsample[i][j-workWindow];
+			sum+=d[j+w]-d[j-w];
 			if(sum<0)
 				sum=0;
-			activity[i][j]=(sum/workWindow/2)/l2downnorm[i]*1000;
+			a[j]=(sum/workWindow/2)/l2downnorm[i]*1000;
 		}
 	}
 
@@ -76,23 +90,40 @@ void CrosstalkGate::gate(Channels &channels,unsigned downsampleLevel,double wind
 	}
 
 
-	for(unsigned i=0;i<channels[0].size();i++)
+	std::vector<std::size_t> sizes(channels.size());
+	for(unsigned c=0;c<channels.size();c++)
+		sizes[c]=channels[c].size();
+
+	std::vector<Span<const float> > a(activity.size());
+	for(unsigned c=0;c<activity.size();c++)
+		a[c]=activity[c].view();
+	const std::size_t size=sizes[0];
+
+	Channels gain(channels.size());
+	std::vector<Span<float> > g(channels.size());
+	for(unsigned c=0;c<channels.size();c++)
+	{
+		gain[c]=Channel(channels[c].samplerate(),sizes[c]<size?sizes[c]:size);
+		g[c]=gain[c].span();
+	}
+
+	for(std::size_t i=0;i<size;i++)
 	{
 		double maxActivity=1e-10;
-		unsigned j=i/downsampleLevel;
-		float    f=double(i-j*downsampleLevel)/downsampleLevel;
-		for(unsigned c=0;c<channels.size();c++)
+		std::size_t j=i/downsampleLevel;
+		float       f=double(i-j*downsampleLevel)/downsampleLevel;
+		for(unsigned c=0;c<a.size();c++)
 		{
-			float my_act=activity[c][j]*(1-f)+activity[c][j+1]*f;
+			float my_act=a[c].get(j)*(1-f)+a[c].get(j+1)*f;
 			if(my_act>maxActivity)
 				maxActivity=my_act;
 		}
 		n++;
 		if(n>mixWindow)
 			n=mixWindow;
-		for(unsigned c=0;c<channels.size();c++)
+		for(unsigned c=0;c<a.size();c++)
 		{
-			float my_act=activity[c][j]*(1-f)+activity[c][j+1]*f;
+			float my_act=a[c].get(j)*(1-f)+a[c].get(j+1)*f;
 			float f=my_act/maxActivity;
 
 			memory[c][p]=f;
@@ -100,11 +131,15 @@ void CrosstalkGate::gate(Channels &channels,unsigned downsampleLevel,double wind
 			factor[c]-=memory[c][(p+1)%mixWindow];
 
 
-			channels[c][i]*=(factor[c]/n);//my_act/maxActivity;
+			if(i<sizes[c])
+				g[c][i]=(factor[c]/n);//my_act/maxActivity;
 		}
 		p=(p+1)%mixWindow;
 	}
 
+	for(unsigned c=0;c<channels.size();c++)
+		pipeline.gain(c,gain[c]);
+
 	LOG(logINFO) << "Crossgate done"<< std::endl;
 
 }
@@ -11,6 +11,7 @@
 #define CROSSTALKGATE_H_
 
 #include "Channel.h"
+#include "Pipeline.h"
 
 /**
  * @brief Simple and robust crosstalk gate
@@ -45,6 +46,16 @@ public:
 	 */
 	static void gate(Channels &aChannels,unsigned aDownsampleLevel,double windowsec=0.1,double mixsec=0.1);
 
+	/**
+	 * Crosstalk gate adding its muting factors as gain curves to a
+	 * pipeline instead of applying them, see gate(Channels&,unsigned,double,double)
+	 * @param aPipeline				pipeline on the audio channels
+	 * @param aDownsampleLevel		downsample factor
+	 * @param windowsec				activity window (in seconds)
+	 * @param mixsec				mixing average window (in seconds)
+	 */
+	static void gate(Pipeline &aPipeline,unsigned aDownsampleLevel,double windowsec=0.1,double mixsec=0.1);
+
 };
 
 #endif /* CROSSTALKGATE_H_ */
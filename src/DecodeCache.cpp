@@ -0,0 +1,370 @@
+/**
+ * @file		DecodeCache.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		On-disk cache of decoded input files
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "DecodeCache.h"
+#include "Log.h"
+
+std::string DecodeCache::directory;
+std::size_t DecodeCache::limit=DecodeCache::defaultLimit;
+
+/**
+ * Identification of cache files
+ */
+static const char magic[8]={'O','S','P','A','C','P','C','M'};
+
+/**
+ * Version of the cache file format, also detects a foreign byte order
+ */
+static const uint32_t formatVersion=1;
+
+/**
+ * Channel data starts at multiples of this offset, so it can be mapped
+ */
+static const std::size_t alignment=4096;
+
+/**
+ * Cache files are removed by one thread at a time
+ */
+static std::mutex evictLock;
+
+/**
+ * Start of a cache file, followed by the key and the channel table
+ */
+struct CacheHeader
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	channels;
+	uint32_t	keyLength;
+	uint32_t	reserved;
+};
+
+/**
+ * Entry of the channel table of a cache file
+ */
+struct CacheChannel
+{
+	uint32_t	rate;
+	uint32_t	reserved;
+	uint64_t	frames;
+	uint64_t	offset;
+};
+
+static std::size_t aligned(std::size_t offset)
+{
+	return (offset+alignment-1)/alignment*alignment;
+}
+
+/**
+ * Write data at an offset of a file
+ * @param fd     descriptor of file
+ * @param data   data to write
+ * @param size   number of bytes
+ * @param offset offset in file
+ * @return false on errors
+ */
+static bool writeAt(int fd,const void * data,std::size_t size,off_t offset)
+{
+	const char * p=(const char *)data;
+	while(size>0)
+	{
+		ssize_t n=pwrite(fd,p,size,offset);
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<=0)
+			return false;
+		p+=n;
+		size-=n;
+		offset+=n;
+	}
+	return true;
+}
+
+/**
+ * Read data from an offset of a file
+ * @param fd     descriptor of file
+ * @param data   target of data
+ * @param size   number of bytes
+ * @param offset offset in file
+ * @return false on errors or at the end of the file
+ */
+static bool readAt(int fd,void * data,std::size_t size,off_t offset)
+{
+	char * p=(char *)data;
+	while(size>0)
+	{
+		ssize_t n=pread(fd,p,size,offset);
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<=0)
+			return false;
+		p+=n;
+		size-=n;
+		offset+=n;
+	}
+	return true;
+}
+
+/**
+ * Bit pattern of a float, so the key does not depend on formatting
+ * @param value float value
+ * @return bits of value
+ */
+static uint32_t bitsOf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits,&value,sizeof(bits));
+	return bits;
+}
+
+void DecodeCache::setDirectory(const std::string & name)
+{
+	directory=name;
+	if(name.empty())
+		return;
+
+	// create the directory including its parents
+	for(std::size_t p=name.find('/',1);;p=name.find('/',p+1))
+	{
+		mkdir(name.substr(0,p).c_str(),0755);
+		if(p==std::string::npos)
+			break;
+	}
+
+	struct stat info;
+	if(stat(name.c_str(),&info)!=0 || !S_ISDIR(info.st_mode))
+	{
+		LOG(logERROR) << "Could not create cache directory " << name << std::endl;
+		directory.clear();
+		return;
+	}
+	LOG(logINFO) << "Caching decoded inputs in " << name << std::endl;
+}
+
+void DecodeCache::setLimit(std::size_t bytes)
+{
+	limit=bytes;
+}
+
+bool DecodeCache::key(const std::string & decoder,const std::string & name,float skip,float length,std::string & key)
+{
+	struct stat info;
+	if(stat(name.c_str(),&info)!=0 || !S_ISREG(info.st_mode))
+		return false;
+
+	char * path=realpath(name.c_str(),NULL);
+	std::ostringstream k;
+	k << decoder << '\n' << (path!=NULL ? path : name.c_str()) << '\n'
+	  << info.st_size << ' ' << info.st_mtim.tv_sec << '.' << info.st_mtim.tv_nsec << ' ' << info.st_ino << ' ' << info.st_dev << '\n'
+	  << bitsOf(skip) << ' ' << bitsOf(length) << '\n';
+	free(path);
+
+	key=k.str();
+	return true;
+}
+
+std::string DecodeCache::fileOf(const std::string & key)
+{
+	// 64 bit FNV-1a hash
+	uint64_t hash=14695981039346656037ull;
+	for(unsigned i=0;i<key.size();i++)
+	{
+		hash^=(unsigned char)key[i];
+		hash*=1099511628211ull;
+	}
+	char name[32];
+	snprintf(name,sizeof(name),"%016llx.pcm",(unsigned long long)hash);
+	return directory+"/"+name;
+}
+
+bool DecodeCache::load(const std::string & decoder,const std::string & name,float skip,float length,Channels & target)
+{
+	std::string k;
+	if(!enabled() || !key(decoder,name,skip,length,k))
+		return false;
+
+	std::string file=fileOf(k);
+	int fd=open(file.c_str(),O_RDONLY);
+	if(fd<0)
+		return false;
+
+	struct stat info;
+	CacheHeader header;
+	std::vector<char> stored(k.size());
+	std::vector<CacheChannel> table;
+
+	bool valid=fstat(fd,&info)==0
+	           && readAt(fd,&header,sizeof(header),0)
+	           && memcmp(header.magic,magic,sizeof(magic))==0
+	           && header.version==formatVersion
+	           && header.keyLength==k.size()
+	           && header.channels>0
+	           // the channel table has to fit into the file
+	           && uint64_t(info.st_size)>=sizeof(header)+k.size()
+	           && header.channels<=(uint64_t(info.st_size)-sizeof(header)-k.size())/sizeof(CacheChannel)
+	           && readAt(fd,&stored[0],k.size(),sizeof(header))
+	           && memcmp(&stored[0],k.data(),k.size())==0;
+	if(valid)
+	{
+		table.resize(header.channels);
+		valid=readAt(fd,&table[0],table.size()*sizeof(CacheChannel),sizeof(header)+k.size());
+	}
+	for(unsigned c=0;valid && c<table.size();c++)
+		valid=table[c].rate>0 && table[c].offset<=uint64_t(info.st_size)
+		      && table[c].frames<=(uint64_t(info.st_size)-table[c].offset)/sizeof(float);
+
+	if(!valid)
+	{
+		LOG(logDEBUG) << "Ignoring cache file " << file << " of another input" << std::endl;
+		close(fd);
+		return false;
+	}
+
+	Channels loaded;
+	for(unsigned c=0;valid && c<table.size();c++)
+	{
+		std::shared_ptr<SampleBuffer> buffer=std::make_shared<SampleBuffer>(fd,table[c].offset,
+				                                                             table[c].frames*sizeof(float));
+		valid=buffer->size()==table[c].frames*sizeof(float);
+		loaded.push_back(Channel(table[c].rate,buffer));
+	}
+	if(!valid)
+	{
+		LOG(logWARNING) << "Could not read cache file " << file << ", decoding again" << std::endl;
+		close(fd);
+		return false;
+	}
+	target.insert(target.end(),loaded.begin(),loaded.end());
+
+	// the modification time marks the last use for the eviction
+	futimens(fd,NULL);
+	close(fd);
+
+	LOG(logINFO) << "Loaded " << table.size() << " decoded channels of " << name << " from cache" << std::endl;
+	return true;
+}
+
+bool DecodeCache::store(const std::string & decoder,const std::string & name,float skip,float length,
+		                const Channels & channels,unsigned first)
+{
+	std::string k;
+	if(!enabled() || channels.size()<=first || !key(decoder,name,skip,length,k))
+		return false;
+
+	CacheHeader header;
+	memcpy(header.magic,magic,sizeof(magic));
+	header.version=formatVersion;
+	header.channels=channels.size()-first;
+	header.keyLength=k.size();
+	header.reserved=0;
+
+	std::vector<CacheChannel> table(header.channels);
+	std::size_t size=aligned(sizeof(header)+k.size()+table.size()*sizeof(CacheChannel));
+	for(unsigned c=0;c<table.size();c++)
+	{
+		table[c].rate=channels[first+c].samplerate();
+		table[c].reserved=0;
+		table[c].frames=channels[first+c].size();
+		table[c].offset=size;
+		size=aligned(size+table[c].frames*sizeof(float));
+	}
+
+	if(limit>0 && size>limit)
+	{
+		LOG(logDEBUG) << "Decoded " << name << " exceeds the cache size limit" << std::endl;
+		return false;
+	}
+
+	std::string file=fileOf(k);
+	std::vector<char> temp(file.begin(),file.end());
+	const char pattern[]=".XXXXXX";
+	temp.insert(temp.end(),pattern,pattern+sizeof(pattern));
+
+	int fd=mkstemp(&temp[0]);
+	if(fd<0)
+	{
+		LOG(logWARNING) << "Could not create cache file " << &temp[0] << std::endl;
+		return false;
+	}
+
+	bool ok=ftruncate(fd,size)==0
+	        && writeAt(fd,&header,sizeof(header),0)
+	        && writeAt(fd,k.data(),k.size(),sizeof(header))
+	        && writeAt(fd,&table[0],table.size()*sizeof(CacheChannel),sizeof(header)+k.size());
+	for(unsigned c=0;ok && c<table.size();c++)
+		ok=writeAt(fd,channels[first+c].view().data(),table[c].frames*sizeof(float),table[c].offset);
+	ok=close(fd)==0 && ok;
+
+	// concurrent runs only ever see complete cache files
+	if(!ok || rename(&temp[0],file.c_str())!=0)
+	{
+		LOG(logWARNING) << "Could not write cache file " << file << std::endl;
+		unlink(&temp[0]);
+		return false;
+	}
+
+	LOG(logINFO) << "Stored decoded " << name << " in cache" << std::endl;
+	evict();
+	return true;
+}
+
+void DecodeCache::evict()
+{
+	if(limit==0)
+		return;
+
+	std::lock_guard<std::mutex> guard(evictLock);
+
+	DIR * dir=opendir(directory.c_str());
+	if(dir==NULL)
+		return;
+
+	std::vector<std::pair<time_t,std::string> > files;
+	std::size_t total=0;
+	for(struct dirent * entry=readdir(dir);entry!=NULL;entry=readdir(dir))
+	{
+		std::string name=entry->d_name;
+		if(name.size()!=20 || name.compare(16,4,".pcm")!=0)
+			continue;
+
+		struct stat info;
+		std::string file=directory+"/"+name;
+		if(stat(file.c_str(),&info)!=0)
+			continue;
+		files.push_back(std::make_pair(info.st_mtime,file));
+		total+=info.st_size;
+	}
+	closedir(dir);
+
+	std::sort(files.begin(),files.end());
+	for(unsigned i=0;i<files.size() && total>limit;i++)
+	{
+		struct stat info;
+		if(stat(files[i].second.c_str(),&info)!=0)
+			continue;
+		LOG(logDEBUG) << "Evicting " << files[i].second << " from cache" << std::endl;
+		if(unlink(files[i].second.c_str())==0)
+			total-=info.st_size;
+	}
+}
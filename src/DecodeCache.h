@@ -0,0 +1,119 @@
+/**
+ * @file		DecodeCache.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		On-disk cache of decoded input files
+ */
+
+#ifndef DECODECACHE_H_
+#define DECODECACHE_H_
+
+#include <cstddef>
+#include <string>
+
+#include "Channel.h"
+
+/**
+ * @brief Cache of decoded compressed inputs in a directory
+ *
+ * Decoding compressed inputs like MP3 or M4A takes much longer than the
+ * processing of the samples, and the same inputs are usually processed
+ * many times while tuning the parameters of a production. Once a cache
+ * directory is set, the channels decoded from an input are stored in a
+ * cache file, and later loads of the same input take the channels from
+ * the cache file instead of decoding it again.
+ *
+ * Cache files are named by a hash of their key, which consists of the
+ * decoder, the canonical path, size, modification time and inode of the
+ * input and the loaded time range. Each cache file starts with its full
+ * key, followed by a table of the channels and their float samples at
+ * page aligned offsets, so the channels of a cache hit are mapped from
+ * the file instead of being read (see SampleBuffer).
+ *
+ * Cache files are written to a temporary file and renamed, so concurrent
+ * runs never see partial files. The modification time of a cache file is
+ * its last use: Whenever the total size of the cache exceeds the limit,
+ * the least recently used files are removed.
+ */
+class DecodeCache
+{
+	static std::string	directory;
+	static std::size_t	limit;
+public:
+	/**
+	 * Default size limit of the cache
+	 */
+	static const std::size_t defaultLimit=std::size_t(2048)<<20;
+
+	/**
+	 * Set the cache directory, which is created if needed
+	 * @param name directory name, empty to disable the cache
+	 */
+	static void setDirectory(const std::string & name);
+
+	/**
+	 * Set the maximum total size of all cache files
+	 * @param bytes size limit in bytes
+	 */
+	static void setLimit(std::size_t bytes);
+
+	/**
+	 * Check if a cache directory is set
+	 * @return true if decoded inputs are cached
+	 */
+	static bool enabled() { return !directory.empty(); }
+
+	/**
+	 * Append the cached channels of an input
+	 * @param decoder name of the decoder, part of the key
+	 * @param name    file system name of the input
+	 * @param skip    skipped seconds, part of the key
+	 * @param length  maximum loaded seconds, part of the key
+	 * @param target  channels to append the cached channels to
+	 * @return false if the input is not cached
+	 */
+	static bool load(const std::string & decoder,const std::string & name,float skip,float length,Channels & target);
+
+	/**
+	 * Store the decoded channels of an input and evict least recently
+	 * used cache files above the size limit
+	 * @param decoder  name of the decoder, part of the key
+	 * @param name     file system name of the input
+	 * @param skip     skipped seconds, part of the key
+	 * @param length   maximum loaded seconds, part of the key
+	 * @param channels decoded channels of the input
+	 * @param first    index of the first channel of the input in channels
+	 * @return false if the channels could not be stored
+	 */
+	static bool store(const std::string & decoder,const std::string & name,float skip,float length,
+			          const Channels & channels,unsigned first=0);
+
+private:
+	/**
+	 * Key of an input, identifying the file and its decoding
+	 * @param decoder name of the decoder
+	 * @param name    file system name of the input
+	 * @param skip    skipped seconds
+	 * @param length  maximum loaded seconds
+	 * @param key     resulting key
+	 * @return false if the input file does not exist
+	 */
+	static bool key(const std::string & decoder,const std::string & name,float skip,float length,std::string & key);
+
+	/**
+	 * File name of the cache file of a key
+	 * @param key key of the input
+	 * @return file system name
+	 */
+	static std::string fileOf(const std::string & key);
+
+	/**
+	 * Remove least recently used cache files until the cache fits the
+	 * size limit
+	 */
+	static void evict();
+};
+
+#endif /* DECODECACHE_H_ */
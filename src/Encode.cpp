@@ -9,13 +9,109 @@
 
 #include <unistd.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/wait.h>
 #include <sstream>
+#include <vector>
 
+extern "C" {
+	#include <sndfile.h>
+}
 
 #include "Encode.h"
 #include "Wave.h"
 #include "Log.h"
 
+/**
+ * Run an external encoder and stream the channels as wave file to its
+ * standard input, so no temporary file is needed. The arguments are passed
+ * directly to the encoder, so meta data does not need any quoting.
+ * @param args		encoder and its arguments
+ * @param c			channels to encode
+ * @param filename	destination filename for messages
+ * @return			program return code
+ */
+static int run(const std::vector<std::string> & args,Channels &c,const std::string & filename)
+{
+	std::stringstream stream;
+	for(unsigned i=0;i<args.size();i++)
+		stream << (i>0?" ":"") << args[i];
+	LOG(logINFO) << stream.str() << std::endl;
+
+	std::vector<char *> argv;
+	for(unsigned i=0;i<args.size();i++)
+		argv.push_back(const_cast<char *>(args[i].c_str()));
+	argv.push_back(NULL);
+
+	// the pipe must not leak into encoders started concurrently for other
+	// outputs, or they would keep it open and this encoder never ends
+	int fds[2];
+	if(pipe2(fds,O_CLOEXEC)!=0)
+	{
+		LOG(logERROR) << "Could not create pipe to " << args[0] << std::endl;
+		return 1;
+	}
+
+	pid_t pid=fork();
+	if(pid<0)
+	{
+		LOG(logERROR) << "Could not start " << args[0] << std::endl;
+		close(fds[0]);
+		close(fds[1]);
+		return 1;
+	}
+	if(pid==0)
+	{
+		dup2(fds[0],0);
+		close(fds[0]);
+		close(fds[1]);
+		execvp(argv[0],&argv[0]);
+		_exit(127);
+	}
+	close(fds[0]);
+
+	// an encoder terminating early must not terminate ospac: SIGPIPE is
+	// blocked for this thread only, as other outputs may be written
+	// concurrently, and a pending SIGPIPE is consumed before unblocking
+	sigset_t pipeSignal,previous;
+	sigemptyset(&pipeSignal);
+	sigaddset(&pipeSignal,SIGPIPE);
+	pthread_sigmask(SIG_BLOCK,&pipeSignal,&previous);
+
+	int written=Wave::write(fds[1],c,filename);
+	close(fds[1]);
+
+	struct timespec immediately={0,0};
+	while(sigtimedwait(&pipeSignal,NULL,&immediately)==SIGPIPE);
+	pthread_sigmask(SIG_SETMASK,&previous,NULL);
+
+	int status;
+	while(waitpid(pid,&status,0)<0)
+	{
+		if(errno!=EINTR)
+		{
+			LOG(logERROR) << "Lost " << args[0] << std::endl;
+			return 1;
+		}
+	}
+
+	int result=WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+	if(result==127)
+	{
+		LOG(logERROR) << "Could not run " << args[0] << std::endl;
+	} else
+	if(result!=0)
+	{
+		LOG(logERROR) << args[0] << " failed on " << filename << std::endl;
+	}
+	if(result==0 && written!=0)
+		result=1;
+	return result;
+}
+
 int Encode::lame(Channels &c,
 					std::string filename,
 					QualitySetting quality,
@@ -32,10 +128,6 @@ int Encode::lame(Channels &c,
 	if(c.size()<1)
 		return 0;
 
-	std::string tempfile=filename+".wav";
-
-	Wave::save(tempfile,c);
-
 	unsigned rate=c[0].samplerate();
 	if(rate>44100)
 		rate=44100;
@@ -59,40 +151,36 @@ int Encode::lame(Channels &c,
 		break;
 	}
 
-	std::stringstream stream;
-
-	stream << "lame -V" << Vrate
-		   << " -q0"
-		   << " --lowpass "<< halfrate
-		   << " --resample "<< rate;
-
+	std::vector<std::string> args;
+	args.push_back("lame");
+	args.push_back("-V"+Vrate);
+	args.push_back("-q0");
+	args.push_back("--lowpass");
+	args.push_back(std::to_string(halfrate));
+	args.push_back("--resample");
+	args.push_back(std::to_string(rate));
 
 	if(title!="")
-		stream << " --tt \""<<title<<"\"";
+		args.insert(args.end(),{"--tt",title});
 	if(artist!="")
-		stream << " --ta \""<<artist<<"\"";
+		args.insert(args.end(),{"--ta",artist});
 	if(comment!="")
-		stream << " --tc \""<<comment<<"\"";
+		args.insert(args.end(),{"--tc",comment});
 	if(year!="")
-		stream << " --ty \""<<year<<"\"";
+		args.insert(args.end(),{"--ty",year});
 	if(album!="")
-		stream << " --tl \""<<album<<"\"";
+		args.insert(args.end(),{"--tl",album});
 	if(category!="")
-		stream << " --tg \""<<category<<"\"";
+		args.insert(args.end(),{"--tg",category});
 	if(image!="")
-		stream << " --ti \""<<image<<"\"";
+		args.insert(args.end(),{"--ti",image});
 	if(episode!="")
-		stream << " --tn \""<<episode<<"\"";
-
-	stream << " \""<<tempfile<<"\" \""<<filename<<"\"";
-
-	LOG(logINFO) << stream.str() << std::endl;
+		args.insert(args.end(),{"--tn",episode});
 
-	unsigned result=system(stream.str().c_str());
+	args.push_back("-");
+	args.push_back(filename);
 
-	unlink(tempfile.c_str());
-
-	return result;
+	return run(args,c,filename);
 }
 
 
@@ -111,10 +199,6 @@ int Encode::oggenc(Channels &c,
 	if(c.size()<1)
 		return 0;
 
-	std::string tempfile=filename+".wav";
-
-	Wave::save(tempfile,c);
-
 	unsigned rate=c[0].samplerate();
 	if(rate>44100)
 		rate=44100;
@@ -138,31 +222,181 @@ int Encode::oggenc(Channels &c,
 		break;
 	}
 
-	std::stringstream stream;
+	std::vector<std::string> args;
+	args.push_back("oggenc");
+	args.push_back("-q"+Vrate);
+	args.push_back("--advanced-encode-option");
+	args.push_back("lowpass_frequency="+std::to_string(halfrate));
+
+	if(title!="")
+		args.insert(args.end(),{"-t",title});
+	if(artist!="")
+		args.insert(args.end(),{"-a",artist});
+	if(comment!="")
+		args.insert(args.end(),{"-d",comment});
+	if(album!="")
+		args.insert(args.end(),{"-l",album});
+	if(category!="")
+		args.insert(args.end(),{"-G",category});
+	if(episode!="")
+		args.insert(args.end(),{"-N",episode});
+
+	args.push_back("-");
+	args.push_back("-o");
+	args.push_back(filename);
+
+	return run(args,c,filename);
+}
+
 
-	stream << "oggenc -q" << Vrate
-		   << " --advanced-encode-option lowpass_frequency="<< halfrate;
 
+/**
+ * Variable bit rate quality of a quality preset
+ * @param quality	quality preset
+ * @param levels	qualities in [0,1] of LOW, STANDARD, HIGH and INSANE
+ * @return			quality of preset
+ */
+static double vbrOf(Encode::QualitySetting quality,const double levels[4])
+{
+	switch(quality)
+	{
+	case Encode::LOW:
+		return levels[0];
+	case Encode::HIGH:
+		return levels[2];
+	case Encode::INSANE:
+		return levels[3];
+	case Encode::STANDARD:
+	default:
+		return levels[1];
+	}
+}
+
+int Encode::sndfile(Channels &c,
+					std::string filename,
+					int format,
+					unsigned rate,
+					double vbr,
+					std::string title,
+					std::string artist,
+					std::string album,
+					std::string comment,
+					std::string category,
+					std::string episode,
+					std::string year)
+{
+	if(c.size()<1)
+		return 0;
+
+	// resample a copy, the channels may be saved in other formats as well
+	Channels encoded(c);
+	if(rate!=0 && rate!=c[0].samplerate())
+	{
+		LOG(logINFO) << "Resampling to " << rate << "Hz for " << filename << std::endl;
+		for(unsigned i=0;i<encoded.size();i++)
+			encoded[i]=c[i].resampleTo(rate);
+	}
+
+	Wave::Strings strings;
 	if(title!="")
-		stream << " -t \""<<title<<"\"";
+		strings.push_back(std::make_pair(int(SF_STR_TITLE),title));
 	if(artist!="")
-		stream << " -a \""<<artist<<"\"";
+		strings.push_back(std::make_pair(int(SF_STR_ARTIST),artist));
 	if(comment!="")
-		stream << " -d \""<<comment<<"\"";
+		strings.push_back(std::make_pair(int(SF_STR_COMMENT),comment));
+	if(year!="")
+		strings.push_back(std::make_pair(int(SF_STR_DATE),year));
 	if(album!="")
-		stream << " -l \""<<album<<"\"";
+		strings.push_back(std::make_pair(int(SF_STR_ALBUM),album));
 	if(category!="")
-		stream << " -G \""<<category<<"\"";
+		strings.push_back(std::make_pair(int(SF_STR_GENRE),category));
 	if(episode!="")
-		stream << " -N \""<<episode<<"\"";
+		strings.push_back(std::make_pair(int(SF_STR_TRACKNUMBER),episode));
+	strings.push_back(std::make_pair(int(SF_STR_SOFTWARE),std::string("ospac")));
 
-	stream << " \""<<tempfile<<"\" -o \""<<filename<<"\"";
+	return Wave::save(filename,encoded,format,vbr,strings);
+}
 
-	LOG(logINFO) << stream.str() << std::endl;
+int Encode::mp3(std::string filename)
+{
+	if(channels.size()<1)
+		return 0;
 
-	unsigned result=system(stream.str().c_str());
+	unsigned rate=channels[0].samplerate();
+	if(rate>44100)
+		rate=44100;
 
-	unlink(tempfile.c_str());
+	// lame -V9, -V8.4, -V5 and -V1
+	static const double levels[4]={0.1,0.16,0.5,0.9};
+	const int format=SF_FORMAT_MPEG|SF_FORMAT_MPEG_LAYER_III;
 
-	return result;
+	if(!Wave::supports(format,channels.size(),rate))
+	{
+		LOG(logINFO) << "libsndfile cannot write mp3 files, using lame" << std::endl;
+		return lame(channels,filename,quality,title,artist,album,comment,
+				image,category,episode,year);
+	}
+	if(image!="")
+	{
+		LOG(logWARNING) << "Image " << image << " is not embedded in " << filename << std::endl;
+	}
+	return sndfile(channels,filename,format,rate,vbrOf(quality,levels),
+			title,artist,album,comment,category,episode,year);
+}
+
+int Encode::ogg(std::string filename)
+{
+	if(channels.size()<1)
+		return 0;
+
+	// oggenc -q1, -q2, -q4 and -q6
+	static const double levels[4]={0.1,0.2,0.4,0.6};
+	const int format=SF_FORMAT_OGG|SF_FORMAT_VORBIS;
+
+	if(!Wave::supports(format,channels.size(),channels[0].samplerate()))
+	{
+		LOG(logINFO) << "libsndfile cannot write Ogg Vorbis files, using oggenc" << std::endl;
+		return oggenc(channels,filename,quality,title,artist,album,comment,
+					  category,episode);
+	}
+	return sndfile(channels,filename,format,0,vbrOf(quality,levels),
+			title,artist,album,comment,category,episode,year);
+}
+
+int Encode::flac(std::string filename)
+{
+	if(channels.size()<1)
+		return 0;
+
+	const int format=SF_FORMAT_FLAC|SF_FORMAT_PCM_16;
+
+	if(!Wave::supports(format,channels.size(),channels[0].samplerate()))
+	{
+		LOG(logERROR) << "libsndfile cannot write FLAC files" << std::endl;
+		return 1;
+	}
+	return sndfile(channels,filename,format,0,-1,
+			title,artist,album,comment,category,episode,year);
+}
+
+int Encode::opus(std::string filename)
+{
+	if(channels.size()<1)
+		return 0;
+
+	// Opus only supports few sample rates
+	unsigned rate=channels[0].samplerate();
+	if(rate!=8000 && rate!=12000 && rate!=16000 && rate!=24000)
+		rate=48000;
+
+	static const double levels[4]={0.2,0.3,0.5,0.8};
+	const int format=SF_FORMAT_OGG|SF_FORMAT_OPUS;
+
+	if(!Wave::supports(format,channels.size(),rate))
+	{
+		LOG(logERROR) << "libsndfile cannot write Opus files" << std::endl;
+		return 1;
+	}
+	return sndfile(channels,filename,format,rate,vbrOf(quality,levels),
+			title,artist,album,comment,category,episode,year);
 }
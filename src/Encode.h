@@ -125,28 +125,34 @@ public:
 	#endif
 	
 	/**
-	 * Create mp3 file from builder
+	 * Create mp3 file from builder, in-process if libsndfile can write
+	 * mp3 files, otherwise using an external lame encoder
 	 * @param filename under which the encoded file shall be saved
-	 * @return return value of external command
+	 * @return return value of encoder
 	 */
-	int    mp3(std::string filename)
-	{
-		return lame(channels,filename,quality,title,artist,album,comment,
-				image,category,episode,year);
+	int    mp3(std::string filename);
 
-	}
+	/**
+	 * Create ogg file from builder, in-process if libsndfile can write
+	 * Ogg Vorbis files, otherwise using an external oggenc encoder
+	 * @param filename under which the encoded file shall be saved
+	 * @return return value of encoder
+	 */
+	int    ogg(std::string filename);
 
 	/**
-	 * Create ogg file from builder
+	 * Create flac file from builder using libsndfile
 	 * @param filename under which the encoded file shall be saved
-	 * @return return value of external command
+	 * @return 0 in case of success, 1 in case of error
 	 */
-	int    ogg(std::string filename)
-	{
-		return oggenc(channels,filename,quality,title,artist,album,comment,
-					  category,episode);
+	int    flac(std::string filename);
 
-	}
+	/**
+	 * Create opus file from builder using libsndfile
+	 * @param filename under which the encoded file shall be saved
+	 * @return 0 in case of success, 1 in case of error
+	 */
+	int    opus(std::string filename);
 	
 	#ifdef HAS_FFMPEG
 	/**
@@ -162,6 +168,36 @@ public:
 
 protected:
 
+	/**
+	 * Encode given audio segment in-process using libsndfile
+	 * @param c			channels to encode
+	 * @param filename	destination filename
+	 * @param format	libsndfile major and minor format
+	 * @param rate		sample rate of the encoded file, 0 to keep the rate
+	 * @param vbr		variable bit rate quality in [0,1], negative for the
+	 *                  default of the encoder
+	 * @param title		title of the track
+	 * @param artist	artist of the track
+	 * @param album		album/podcast of the track
+	 * @param comment	comment/license of the track
+	 * @param category	category (such as Speech)
+	 * @param episode	track/episode number
+	 * @param year		year of the recording/publication
+	 * @return			0 in case of success, 1 in case of error
+	 */
+	static int sndfile(Channels &c,
+					std::string filename,
+					int format,
+					unsigned rate,
+					double vbr,
+					std::string title,
+					std::string artist,
+					std::string album,
+					std::string comment,
+					std::string category,
+					std::string episode,
+					std::string year);
+
 	/**
 	 * Encode given audio segment to mp3 using an external lame encoder
 	 * @param c			channels to encode
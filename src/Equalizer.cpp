@@ -12,20 +12,25 @@
 #include "Frequency.h"
 #include "MonoMix.h"
 
-Channel Equalizer::bandedEqualizer(const Channel & c,
+Channel Equalizer::bandedEqualizer(Channel c,
 			std::vector<float> frequencies,
 			std::vector<float> factors)
 {
-	Channels bands=Frequency::split(c,frequencies);
+	Channels bands=Frequency::split(std::move(c),frequencies);
 
 	MonoMix target;
-	for(unsigned i=0;i<factors.size() && i<bands.size();i++)
+	for(std::size_t i=0;i<factors.size() && i<bands.size();i++)
 		target.mix(bands[i],factors[i]);
 
 	return target.getTarget()[0];
 }
 
 Channel Equalizer::voiceEnhance(const Channel & c)
+{
+	return voiceEnhance(Channel(c));
+}
+
+Channel Equalizer::voiceEnhance(Channel && c)
 {
 	// Attenuation similar to
 	// https://larryjordan.com/articles/eq-warm-a-voice-and-improve-diction/
@@ -40,13 +45,20 @@ Channel Equalizer::voiceEnhance(const Channel & c)
 	factors[2]=1;
 	factors[3]=1.75;
 	factors[4]=0.75;
-	return bandedEqualizer(c,freqs,factors);
+	return bandedEqualizer(std::move(c),freqs,factors);
 }
 
 Channels Equalizer::voiceEnhance(const Channels & c)
 {
 	Channels target(c.size());
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 		target[i]=voiceEnhance(c[i]);
 	return target;
 }
+
+Channels Equalizer::voiceEnhance(Channels && c)
+{
+	for(std::size_t i=0;i<c.size();i++)
+		c[i]=voiceEnhance(std::move(c[i]));
+	return std::move(c);
+}
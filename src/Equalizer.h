@@ -27,7 +27,7 @@ public:
 	 * @param factors		n+1 amplication factors
 	 * @return	resulting audio channel
 	 */
-	static Channel bandedEqualizer(const Channel & c,
+	static Channel bandedEqualizer(Channel c,
 			std::vector<float> frequencies,
 			std::vector<float> factors);
 	/**
@@ -37,12 +37,26 @@ public:
 	 */
 	static Channel voiceEnhance(const Channel & c);
 
+	/**
+	 * Preset equalizer for a temporary voice channel, reusing its samples
+	 * @param c	audio channel to work on
+	 * @return	resulting audio channel
+	 */
+	static Channel voiceEnhance(Channel && c);
+
 	/**
 	 * Preset equalizer for voice channels
 	 * @param c	audio channels to work on
 	 * @return	resulting audio channel
 	 */
 	static Channels voiceEnhance(const Channels & c);
+
+	/**
+	 * Preset equalizer for temporary voice channels, reusing their samples
+	 * @param c	audio channels to work on
+	 * @return	resulting audio channel
+	 */
+	static Channels voiceEnhance(Channels && c);
 };
 
 #endif /* EQUALIZER_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file		FrameBuffer.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Contiguous block-interleaved storage of multiple channels
+ */
+
+#include <string.h>
+
+#include "FrameBuffer.h"
+
+std::size_t FrameBuffer::bytes(unsigned channels,std::size_t frames)
+{
+	std::size_t blocks=(frames+blockFrames-1)>>blockShift;
+	return blocks*channels*blockFrames*sizeof(float);
+}
+
+FrameBuffer::FrameBuffer(unsigned aRate,unsigned channels,std::size_t frames)
+	: rate(aRate), count(channels), length(frames), buffer(bytes(channels,frames))
+{
+}
+
+void FrameBuffer::load(const Channels & channels,std::size_t first)
+{
+	for(unsigned c=0;c<count;c++)
+	{
+		Span<const float> s=channels[c].view();
+		ChannelView v=channel(c);
+		for(std::size_t start=0,b=0;start<length;start+=blockFrames,b++)
+		{
+			Span<float> d=v.segment(b);
+			std::size_t from=first+start;
+			std::size_t n=from<s.size()?s.size()-from:0;
+			if(n>d.size())
+				n=d.size();
+			memcpy(d.data(),s.data()+from,n*sizeof(float));
+			memset(d.data()+n,0,(d.size()-n)*sizeof(float));
+		}
+	}
+}
+
+void FrameBuffer::store(Channels & channels,std::size_t first) const
+{
+	for(unsigned c=0;c<count;c++)
+	{
+		if(first>=channels[c].size())
+			continue;
+		Span<float> s=channels[c].span();
+		for(std::size_t start=0,b=0;start<length;start+=blockFrames,b++)
+		{
+			std::size_t to=first+start;
+			std::size_t n=to<s.size()?s.size()-to:0;
+			if(n>length-start)
+				n=length-start;
+			if(n>blockFrames)
+				n=blockFrames;
+			memcpy(s.data()+to,samples()+(b*count+c)*blockFrames,n*sizeof(float));
+		}
+	}
+}
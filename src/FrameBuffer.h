@@ -0,0 +1,223 @@
+/**
+ * @file		FrameBuffer.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Contiguous block-interleaved storage of multiple channels
+ */
+
+#ifndef FRAMEBUFFER_H_
+#define FRAMEBUFFER_H_
+
+#include "Channel.h"
+#include "SampleBuffer.h"
+#include "Span.h"
+
+/**
+ * @brief Multiple channels of equal length in one contiguous buffer
+ *
+ * Filters that work on all channels at once, e.g. to sum up the energy of
+ * a frame, touch every channel for every sample. With separate channels
+ * this means one independent memory stream per channel. The frame buffer
+ * keeps all channels in one buffer in a block-interleaved layout: The
+ * frames are grouped in blocks of blockFrames frames, and each block holds
+ * the samples of all channels, one contiguous segment per channel:
+ *
+ *     block 0: channel 0 [0..B-1], channel 1 [0..B-1], ...
+ *     block 1: channel 0 [B..2B-1], channel 1 [B..2B-1], ...
+ *
+ * So the samples of one frame are close to each other, while the samples
+ * of a channel within a block are contiguous and can be processed by
+ * vectorized loops on a segment().
+ *
+ * A frame buffer is meant as a window of a few blocks that streams over
+ * the channels: load() fills it from a position of the channels, the
+ * filter works on the window, and store() writes it back. So the memory
+ * needed besides the channels stays at the size of the window.
+ *
+ * The storage is a SampleBuffer, so large frame buffers are spilled to
+ * memory mapped temporary files as well. Accesses are not bounds checked
+ * except for get().
+ */
+class FrameBuffer
+{
+	unsigned		rate;
+	unsigned		count;
+	std::size_t		length;
+	SampleBuffer	buffer;
+public:
+	/**
+	 * Binary logarithm of the number of frames in a block
+	 */
+	static const unsigned blockShift=8;
+
+	/**
+	 * Number of frames in a block
+	 */
+	static const unsigned blockFrames=1u<<blockShift;
+
+	/**
+	 * @brief View on a single channel of a frame buffer
+	 */
+	class ChannelView
+	{
+		float *		first;
+		std::size_t	stride;
+		std::size_t	length;
+	public:
+		/**
+		 * Create a view on a channel
+		 * @param aFirst  first sample of the channel in the first block
+		 * @param aStride distance of two blocks in samples
+		 * @param aLength number of frames
+		 */
+		ChannelView(float * aFirst,std::size_t aStride,std::size_t aLength)
+			: first(aFirst), stride(aStride), length(aLength) {}
+
+		/**
+		 * Unchecked access to a sample
+		 * @param index of frame (0<=index<size())
+		 * @return reference on sample
+		 */
+		float & operator [](std::size_t index) const
+		{
+			return first[(index>>blockShift)*stride+(index&(blockFrames-1))];
+		}
+
+		/**
+		 * Contiguous part of the channel within a block
+		 * @param block index of block
+		 * @return span on the samples of the block (shorter for the last block)
+		 */
+		Span<float> segment(std::size_t block) const
+		{
+			std::size_t start=block<<blockShift;
+			std::size_t n=start<length?length-start:0;
+			return Span<float>(first+block*stride,n<blockFrames?n:blockFrames);
+		}
+
+		/**
+		 * Number of frames
+		 * @return number of samples of the channel
+		 */
+		std::size_t size() const { return length; }
+	};
+
+	/**
+	 * Create a zero frame buffer
+	 * @param rate     sample rate in Hertz (1/s)
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 */
+	FrameBuffer(unsigned rate,unsigned channels,std::size_t frames);
+
+	/**
+	 * Fill the buffer with the frames of the channels starting at given
+	 * position. Samples beyond the end of a channel are set to zero.
+	 * The channels are expected to share the sample rate of the buffer.
+	 * @param channels channels to be read, at least channels() of them
+	 * @param first    index of the frame copied to the first frame
+	 */
+	void load(const Channels & channels,std::size_t first);
+
+	/**
+	 * Copy the buffer back to the frames of the channels starting at given
+	 * position. Frames beyond the end of a channel are dropped, the
+	 * channels keep their length.
+	 * @param channels target channels, at least channels() of them
+	 * @param first    index of the frame receiving the first frame
+	 */
+	void store(Channels & channels,std::size_t first) const;
+
+	/**
+	 * Unchecked access to a sample
+	 * @param channel index of channel
+	 * @param frame   index of frame
+	 * @return reference on sample
+	 */
+	float & operator ()(unsigned channel,std::size_t frame)
+	{
+		return samples()[((frame>>blockShift)*count+channel)*blockFrames+(frame&(blockFrames-1))];
+	}
+
+	/**
+	 * Unchecked read access to a sample
+	 * @param channel index of channel
+	 * @param frame   index of frame
+	 * @return sample value
+	 */
+	float operator ()(unsigned channel,std::size_t frame) const
+	{
+		return samples()[((frame>>blockShift)*count+channel)*blockFrames+(frame&(blockFrames-1))];
+	}
+
+	/**
+	 * Read access to a sample, zero beyond the last frame
+	 * @param channel index of channel
+	 * @param frame   index of frame
+	 * @return sample value or zero
+	 */
+	float get(unsigned channel,std::size_t frame) const
+	{
+		return frame<length ? (*this)(channel,frame) : 0;
+	}
+
+	/**
+	 * View on a single channel
+	 * @param channel index of channel
+	 * @return view on channel samples
+	 */
+	ChannelView channel(unsigned channel)
+	{
+		return ChannelView(samples()+std::size_t(channel)*blockFrames,std::size_t(count)*blockFrames,length);
+	}
+
+	/**
+	 * Contiguous part of a channel within a block
+	 * @param channel index of channel
+	 * @param block   index of block
+	 * @return span on the samples of the block (shorter for the last block)
+	 */
+	Span<float> segment(unsigned channel,std::size_t block) { return this->channel(channel).segment(block); }
+
+	/**
+	 * Number of channels
+	 * @return number of channels
+	 */
+	unsigned channels() const { return count; }
+
+	/**
+	 * Number of frames, i.e. samples per channel
+	 * @return number of frames
+	 */
+	std::size_t frames() const { return length; }
+
+	/**
+	 * Number of blocks covering all frames
+	 * @return number of blocks
+	 */
+	std::size_t blocks() const { return (length+blockFrames-1)>>blockShift; }
+
+	/**
+	 * Sample rate of all channels
+	 * @return sample rate in Hertz (1/s)
+	 */
+	unsigned samplerate() const { return rate; }
+
+private:
+	FrameBuffer(const FrameBuffer &);
+	FrameBuffer & operator =(const FrameBuffer &);
+
+	float * samples() const { return (float*)buffer.data(); }
+
+	/**
+	 * Number of bytes needed for given size
+	 * @param channels number of channels
+	 * @param frames   number of frames
+	 * @return size of storage in bytes
+	 */
+	static std::size_t bytes(unsigned channels,std::size_t frames);
+};
+
+#endif /* FRAMEBUFFER_H_ */
@@ -8,7 +8,7 @@
  */
 
 #include <math.h>
-
+#include <algorithm>
 
 #include "Frequency.h"
 #include "Log.h"
@@ -32,14 +32,24 @@ double   Frequency::kernel0(double f)
 
 Channel	Frequency::convolution(const Channel &a,const Channel &kernel)
 {
-	Channel target(a);
-	int m2=kernel.size()/2;
-	for(unsigned x=0;x<a.size();x++)
+	Channel target(a.samplerate(),a.size());
+	const long m2=kernel.size()/2;
+	const long n=a.size();
+	Span<const float> s=a.view();
+	Span<const float> k=kernel.view();
+	Span<float> t=target.span();
+	for(long x=0;x<n;x++)
 	{
 		double sum=0;
-		for(unsigned y=0;y<kernel.size() && y<=x+m2 && x+m2-y<a.size();y++)
-			sum+=a[x+m2-y]*kernel[y];
-		target[x]=sum;
+		// samples within m2 of the end remain zero, the window is not shifted
+		if(x+m2<n)
+		{
+			const long count=std::min((long)k.size(),x+m2+1);
+			const float * p=s.data()+x+m2;
+			for(long y=0;y<count;y++)
+				sum+=p[-y]*k[y];
+		}
+		t[x]=sum;
 	}
 	return target;
 }
@@ -59,6 +69,11 @@ unsigned Frequency::windowSize(const Channel & a,float f,float width)
 }
 
 Channels Frequency::split(const Channel & a,float f,float width,bool fade)
+{
+	return split(Channel(a),f,width,fade);
+}
+
+Channels Frequency::split(Channel && a,float f,float width,bool fade)
 {
 	if(width>f)
 			width=f;
@@ -86,11 +101,11 @@ Channels Frequency::split(const Channel & a,float f,float width,bool fade)
 
 	Channels target(2);
 	target[0]=convolution(a,kernel);
-	target[1]=a;
+	target[1]=std::move(a);
 
 	if(fade)
 	{
-		for(unsigned i=0;i<N*2 && i<target[0].size();i++)
+		for(std::size_t i=0;i<N*2 && i<target[0].size();i++)
 		{
 			double f=(double(i)-N)/N;
 			if(f<0)
@@ -101,14 +116,18 @@ Channels Frequency::split(const Channel & a,float f,float width,bool fade)
 		}
 	}
 
-	for(unsigned x=0;x<a.size();x++)
-		target[1][x]-=target[0][x];
+	{
+		Span<float> high=target[1].span();
+		Span<const float> low=target[0].view();
+		for(std::size_t x=0;x<high.size();x++)
+			high[x]-=low[x];
+	}
 
 	Channel temp=convolution(target[1],kernel);
 
 	if(fade)
 	{
-		for(unsigned i=0;i<N*2 && i<temp.size();i++)
+		for(std::size_t i=0;i<N*2 && i<temp.size();i++)
 		{
 			double f=(double(i)-N)/N;
 			if(f<0)
@@ -120,10 +139,13 @@ Channels Frequency::split(const Channel & a,float f,float width,bool fade)
 	}
 
 
-	for(unsigned x=0;x<a.size();x++)
+	Span<float> low=target[0].span();
+	Span<float> high=target[1].span();
+	Span<const float> t=temp.view();
+	for(std::size_t x=0;x<t.size();x++)
 	{
-		target[0][x]+=temp[x];
-		target[1][x]-=temp[x];
+		low[x]+=t[x];
+		high[x]-=t[x];
 	}
 
 	return target;
@@ -136,9 +158,9 @@ Channels Frequency::split(Channel a,std::vector<float> cutoff,float width,bool f
 	unsigned i;
 	for(i=0;i<cutoff.size();i++)
 	{
-		Channels temp=split(a,cutoff[i],width,false);
-		target[i]=temp[0];
-		a=temp[1];
+		Channels temp=split(std::move(a),cutoff[i],width,false);
+		target[i]=std::move(temp[0]);
+		a=std::move(temp[1]);
 		/*temp=split(a,cutoff[i]);
 		for(unsigned j=0;j<a.size();j++)
 			target[i][j]+=temp[0][j];
@@ -146,7 +168,7 @@ Channels Frequency::split(Channel a,std::vector<float> cutoff,float width,bool f
 		if(fade)
 		{
 			unsigned N=windowSize(a,cutoff[i],width);
-			for(unsigned j=0;j<N*2 && j<target[i].size();j++)
+			for(std::size_t j=0;j<N*2 && j<target[i].size();j++)
 			{
 				double f=(double(j)-N)/N;
 				if(f<0)
@@ -157,7 +179,7 @@ Channels Frequency::split(Channel a,std::vector<float> cutoff,float width,bool f
 			}
 		}
 	}
-	target[i]=a;
+	target[i]=std::move(a);
 
 
 	//Wave::save("bands.wav",target);
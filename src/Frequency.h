@@ -34,6 +34,17 @@ public:
 	 */
 	static Channels split(const Channel &a,float cutoff,float width=1000,bool fade=false);
 
+	/**
+	 * Split a temporary channel in a high-frequency and low-frequency part,
+	 * the samples of the given channel are reused for the high-frequency part
+	 * @param a given channel
+	 * @param cutoff frequency
+	 * @param width  transition bandwidth
+	 * @param fade   mute unfiltered start and end and fade in and out
+	 * @return two channels with lower and higher frequency part
+	 */
+	static Channels split(Channel &&a,float cutoff,float width=1000,bool fade=false);
+
 	/**
 	 * Band filter a given channel with respect to cutoff frequencies
 	 * @param a given channel
@@ -0,0 +1,190 @@
+/**
+ * @file		InputQueue.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Concurrent loading of the input files of a segment
+ */
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include "InputQueue.h"
+#include "AudioSource.h"
+#include "Wave.h"
+#include "MonoMix.h"
+#include "Plan.h"
+#include "Log.h"
+
+void InputQueue::add(const std::string & name,Mode mode,float skip,float length,int samplerate)
+{
+	Input input;
+	input.name=name;
+	input.mode=mode;
+	input.skip=skip;
+	input.length=length;
+	input.samplerate=samplerate;
+	inputs.push_back(input);
+}
+
+void InputQueue::decode(Input & input)
+{
+	if(input.mode==ALL)
+	{
+		#ifdef HAS_FFMPEG
+		Wave::loadFfmpeg(input.name,input.channels,input.skip,input.length);
+		#else
+		Wave::load(input.name,input.channels,input.skip,input.length);
+		#endif
+		return;
+	}
+	if(input.mode==ASCII)
+	{
+		Wave::loadAscii(input.name,input.samplerate,input.channels,input.skip,input.length);
+		return;
+	}
+
+	ShortChannels temp;
+	Wave::load(input.name,temp,input.skip,input.length);
+	if(temp.size()==0)
+		return;
+
+	switch(input.mode)
+	{
+		case LEFT:
+			input.channels.push_back(Channel(temp[0]));
+			break;
+		case RIGHT:
+			input.channels.push_back(Channel(temp[temp.size()>1 ? 1 : 0]));
+			break;
+		default:
+			if(temp.size()==1)
+				input.channels.push_back(Channel(temp[0]));
+			else
+			{
+				Channels all;
+				for(unsigned c=0;c<temp.size();c++)
+					all.push_back(Channel(temp[c]));
+				temp=ShortChannels();
+				MonoMix mix;
+				mix.mix(all);
+				input.channels.push_back(mix.getTarget()[0]);
+			}
+			break;
+	}
+}
+
+bool InputQueue::load(Channels & target)
+{
+	if(inputs.empty())
+		return true;
+
+	unsigned cores=std::thread::hardware_concurrency();
+	unsigned workers=cores;
+	if(workers==0 || workers>inputs.size())
+		workers=inputs.size();
+
+	// ascii inputs share the cores with the other inputs
+	AsciiSource::setThreads(cores/workers>1 ? cores/workers : 1);
+
+	std::vector<std::exception_ptr> errors(inputs.size());
+	std::atomic<unsigned> next(0);
+	auto work=[&]()
+	{
+		for(unsigned k=next++;k<inputs.size();k=next++)
+		{
+			try
+			{
+				decode(inputs[k]);
+			}
+			catch(...)
+			{
+				errors[k]=std::current_exception();
+			}
+		}
+	};
+
+	if(workers>1)
+	{
+		LOG(logDEBUG) << "Loading " << inputs.size() << " inputs with " << workers << " threads" << std::endl;
+		std::vector<std::thread> pool;
+		for(unsigned t=0;t<workers;t++)
+			pool.push_back(std::thread(work));
+		for(unsigned t=0;t<pool.size();t++)
+			pool[t].join();
+	} else
+		work();
+	AsciiSource::setThreads(0);
+
+	std::vector<Input> done;
+	done.swap(inputs);
+
+	for(unsigned k=0;k<done.size();k++)
+	{
+		if(errors[k])
+			std::rethrow_exception(errors[k]);
+
+		if(done[k].channels.empty() && (done[k].mode==ALL || done[k].mode==ASCII))
+		{
+			LOG(logERROR) << "Could not load " << done[k].name << std::endl;
+			return false;
+		}
+		for(unsigned c=0;c<done[k].channels.size();c++)
+			target.push_back(std::move(done[k].channels[c]));
+	}
+	return true;
+}
+
+bool InputQueue::probe(Plan & plan)
+{
+	std::vector<Input> queued;
+	queued.swap(inputs);
+
+	for(unsigned k=0;k<queued.size();k++)
+	{
+		const Input & input=queued[k];
+
+		Plan::Decoder decoder=Plan::SNDFILE;
+		if(input.mode==ASCII)
+			decoder=Plan::ASCII;
+		#ifdef HAS_FFMPEG
+		if(input.mode==ALL)
+			decoder=Plan::FFMPEG;
+		#endif
+
+		Plan::Shapes shapes;
+		double cost=Plan::probe(input.name,decoder,input.skip,input.length,input.samplerate,shapes);
+		if(cost<0 || shapes.empty())
+		{
+			if(input.mode==ALL || input.mode==ASCII)
+			{
+				LOG(logERROR) << "Could not probe " << input.name << std::endl;
+				return false;
+			}
+			continue;
+		}
+
+		// single channels are taken from the decoded 16 bit samples
+		double extra=0;
+		switch(input.mode)
+		{
+			case LEFT:
+			case RIGHT:
+				extra=Plan::bytes(shapes)/2;
+				shapes.resize(1);
+				break;
+			case MONO:
+				if(shapes.size()>1)
+					extra=Plan::bytes(shapes)*3/2;
+				shapes.resize(1);
+				break;
+			default:
+				break;
+		}
+		plan.stage("load "+input.name,Plan::bytes(shapes)+extra,cost);
+		plan.work.insert(plan.work.end(),shapes.begin(),shapes.end());
+	}
+	return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file		InputQueue.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Concurrent loading of the input files of a segment
+ */
+
+#ifndef INPUTQUEUE_H_
+#define INPUTQUEUE_H_
+
+#include <string>
+#include <vector>
+
+#include "Channel.h"
+
+class Plan;
+
+/**
+ * @brief Queue of input files that are decoded concurrently
+ *
+ * The command line names the input files of a segment one after another,
+ * but they are only needed once the segment is rendered. The inputs are
+ * therefore collected with add() and decoded by a pool of worker threads
+ * in load(), which appends the channels in the order the inputs were
+ * added, independent of the order in which the decoding finished.
+ */
+class InputQueue
+{
+public:
+	/**
+	 * Channels to take from an input
+	 */
+	enum Mode {
+		ALL,	//!< all channels of a wave file
+		LEFT,	//!< left channel of a wave file
+		RIGHT,	//!< right channel of a wave file
+		MONO,	//!< mono mix-down of all channels of a wave file
+		ASCII	//!< ascii file with one channel per column
+	};
+
+private:
+	/**
+	 * Queued input and its decoded channels
+	 */
+	struct Input
+	{
+		std::string	name;
+		Mode		mode;
+		float		skip;
+		float		length;
+		int			samplerate;
+		Channels	channels;
+	};
+
+	std::vector<Input>	inputs;
+
+	/**
+	 * Decode one input into its channels
+	 * @param input input to decode
+	 */
+	static void decode(Input & input);
+
+public:
+	/**
+	 * Queue an input file
+	 * @param name       file system name of file
+	 * @param mode       channels to take from the file
+	 * @param skip       seconds to skip
+	 * @param length     maximum seconds to load after skip
+	 * @param samplerate sample rate of ascii files
+	 */
+	void add(const std::string & name,Mode mode,float skip=0,float length=1e+99,int samplerate=44100);
+
+	/**
+	 * Check for queued inputs
+	 * @return true if no input is queued
+	 */
+	bool empty() const { return inputs.empty(); }
+
+	/**
+	 * Decode all queued inputs concurrently and append their channels in
+	 * queue order. The queue is empty afterwards.
+	 * @param target channels to append the inputs to
+	 * @return false if a wave or ascii file could not be loaded
+	 */
+	bool load(Channels & target);
+
+	/**
+	 * Probe the headers of all queued inputs instead of decoding them and
+	 * append the shapes of their channels to the work of a plan. The queue
+	 * is empty afterwards.
+	 * @param plan projection to record the loading in
+	 * @return false if a wave or ascii file could not be probed
+	 */
+	bool probe(Plan & plan);
+};
+
+#endif /* INPUTQUEUE_H_ */
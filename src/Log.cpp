@@ -24,18 +24,18 @@ std::clock_t  Log::clockStart=clock();
 bool          Log::showFunction=false;
 bool		  Log::showRuntime=false;
 
-std::ostream & Log::Get(std::string file,int line,TLogLevel level)
-{
-	std::ostream *o;
+std::mutex    Log::lock;
 
+Log::Line::Line(const std::string & file,int line,TLogLevel level)
+{
 	if(level<=logERROR)
-		o=errOutput;
+		output=errOutput;
 	else
-		o=stdOutput;
+		output=stdOutput;
 
 	if(showRuntime)
-		(*o) << std::setw(7) << std::setprecision(2) << std::fixed
-			 << int(clock()/double(CLOCKS_PER_SEC)*100)/100. << "\t";
+		buffer << std::setw(7) << std::setprecision(2) << std::fixed
+			   << int(clock()/double(CLOCKS_PER_SEC)*100)/100. << "\t";
 	if(showFunction)
 	{
 		char number[20];
@@ -45,7 +45,13 @@ std::ostream & Log::Get(std::string file,int line,TLogLevel level)
 			target.insert(target.size(), 30-target.size(),' ');
 
 
-		(*o) << std::setw(25) << target << "\t";
+		buffer << std::setw(25) << target << "\t";
 	}
-	return *o;
+}
+
+Log::Line::~Line()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	(*output) << buffer.str();
+	output->flush();
 }
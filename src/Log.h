@@ -15,8 +15,10 @@
 #define LOG_H_
 
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <ctime>
+#include <mutex>
 
 /**
  * @def LOG(level)
@@ -32,12 +34,12 @@
  *  if(logDEBUG > LOG::getLoglevel())
  *  	; // do nothing
  *  else
- *  	LOG::GET(__FILE__,__LINE__,logDEBUG) << "test information " ...
+ *  	Log::Line(__FILE__,__LINE__,logDEBUG).stream() << "test information " ...
  */
 
 #define LOG(level) \
 if (level > Log::getLoglevel()) ; \
-else Log::Get(__FILE__,__LINE__,level)
+else Log::Line(__FILE__,__LINE__,level).stream()
 
 /**
  * Logging Levels
@@ -56,16 +58,40 @@ private:
 	static std::clock_t	  clockStart;
 	static bool           showFunction;
 	static bool			  showRuntime;
+	static std::mutex	  lock;
 	
 public:
 	/**
-	 * Return suitable stream for logging level and write configured prefix
-	 * @param file Source file
-	 * @param line Source line
-	 * @param level Logging Level
-	 * @return output stream for logging
+	 * @brief Single logging message
+	 *
+	 * The message is collected in a buffer and written to the logging
+	 * stream at once at the end of the statement, so messages of
+	 * concurrent threads do not interleave.
 	 */
-	static std::ostream & Get(std::string file, int line,TLogLevel level = logINFO);
+	class Line
+	{
+		std::ostringstream	buffer;
+		std::ostream *		output;
+	public:
+		/**
+		 * Start a message and write the configured prefix
+		 * @param file Source file
+		 * @param line Source line
+		 * @param level Logging Level
+		 */
+		Line(const std::string & file,int line,TLogLevel level = logINFO);
+
+		/**
+		 * Write the message to the suitable stream for the logging level
+		 */
+		~Line();
+
+		/**
+		 * Stream to write the message to
+		 * @return message stream
+		 */
+		std::ostream & stream() { return buffer; }
+	};
 
 	/**
 	 * Set both error and standard logging output stream
@@ -0,0 +1,233 @@
+/**
+ * @file		MappedWave.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Memory mapped reading of uncompressed wave files
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <memory>
+
+#include "MappedWave.h"
+#include "Convert.h"
+#include "Log.h"
+
+/**
+ * Pages before the read position are released in steps of this many bytes
+ */
+static const std::size_t releaseStep=std::size_t(16)<<20;
+
+static uint16_t le16(const unsigned char * p)
+{
+	return p[0] | p[1]<<8;
+}
+
+static uint32_t le32(const unsigned char * p)
+{
+	return p[0] | p[1]<<8 | p[2]<<16 | uint32_t(p[3])<<24;
+}
+
+static uint64_t le64(const unsigned char * p)
+{
+	return le32(p) | uint64_t(le32(p+4))<<32;
+}
+
+MappedWave::MappedWave(const std::string & name)
+	: fd(-1), mapping(0), mappingSize(0), dataOffset(0), frameCount(0), position(0), released(0),
+	  rate(0), channelCount(0), bytesPerSample(0), isFloat(false)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+	fd=open(name.c_str(),O_RDONLY);
+	if(fd<0)
+		return;
+
+	struct stat info;
+	if(fstat(fd,&info)!=0 || !S_ISREG(info.st_mode) || info.st_size<44)
+	{
+		close(fd);
+		fd=-1;
+		return;
+	}
+
+	void * p=mmap(0,info.st_size,PROT_READ,MAP_SHARED,fd,0);
+	if(p==MAP_FAILED)
+	{
+		close(fd);
+		fd=-1;
+		return;
+	}
+	mapping=(const unsigned char *)p;
+	mappingSize=info.st_size;
+
+	if(!parse())
+	{
+		munmap(p,mappingSize);
+		mapping=0;
+		close(fd);
+		fd=-1;
+		return;
+	}
+
+#ifdef MADV_SEQUENTIAL
+	madvise(p,mappingSize,MADV_SEQUENTIAL);
+#endif
+
+	LOG(logINFO) << "Mapping "<<frameCount<<" frames with "<<channelCount<<" channels with rate "<< rate << std::endl;
+#endif
+}
+
+MappedWave::~MappedWave()
+{
+	if(mapping!=0)
+		munmap((void *)mapping,mappingSize);
+	if(fd>=0)
+		close(fd);
+}
+
+bool MappedWave::parse()
+{
+	const bool rf64=memcmp(mapping,"RF64",4)==0 || memcmp(mapping,"BW64",4)==0;
+	if((!rf64 && memcmp(mapping,"RIFF",4)!=0) || memcmp(mapping+8,"WAVE",4)!=0)
+		return false;
+
+	uint64_t dataSize=0;
+	bool hasFormat=false;
+
+	for(std::size_t p=12;p+8<=mappingSize;)
+	{
+		const unsigned char * chunk=mapping+p;
+		uint64_t size=le32(chunk+4);
+		p+=8;
+
+		if(memcmp(chunk,"ds64",4)==0 && size>=16 && p+16<=mappingSize)
+			dataSize=le64(mapping+p+8);
+		else
+		if(memcmp(chunk,"fmt ",4)==0 && size>=16 && p+16<=mappingSize)
+		{
+			unsigned format=le16(mapping+p);
+			channelCount=le16(mapping+p+2);
+			rate=le32(mapping+p+4);
+			unsigned blockAlign=le16(mapping+p+12);
+			unsigned bits=le16(mapping+p+14);
+			// WAVE_FORMAT_EXTENSIBLE starts the sub format GUID with the format
+			if(format==0xFFFE && size>=40 && p+40<=mappingSize)
+				format=le16(mapping+p+24);
+
+			bytesPerSample=bits/8;
+			isFloat=format==3;
+			if(!((format==1 && (bits==16 || bits==24 || bits==32)) || (format==3 && bits==32)))
+				return false;
+			if(channelCount==0 || rate==0 || blockAlign!=channelCount*bytesPerSample)
+				return false;
+			hasFormat=true;
+		} else
+		if(memcmp(chunk,"data",4)==0)
+		{
+			if(rf64 && size==0xFFFFFFFF)
+				size=dataSize;
+			// leave unfinished and unaligned files to libsndfile
+			if(!hasFormat || size==0 || (bytesPerSample!=3 && p%bytesPerSample!=0))
+				return false;
+			if(size>mappingSize-p)
+				size=mappingSize-p;
+			dataOffset=p;
+			frameCount=size/(channelCount*bytesPerSample);
+			return true;
+		}
+
+		if(size>mappingSize-p)
+			break;
+		p+=size+(size&1);
+	}
+	return false;
+}
+
+std::size_t MappedWave::frames() const
+{
+	return frameCount;
+}
+
+unsigned MappedWave::read(float * const * channels,unsigned frames)
+{
+	if(mapping==0 || position>=frameCount)
+		return 0;
+	if(frames>frameCount-position)
+		frames=frameCount-position;
+
+	const unsigned char * in=mapping+dataOffset+position*channelCount*bytesPerSample;
+
+	// scaled to the range of 16 bit samples, as read by SndfileSource
+	if(isFloat)
+		Convert::deinterleave((const float *)in,channelCount,frames,32768.f,channels);
+	else
+	if(bytesPerSample==2)
+		Convert::deinterleave((const short *)in,channelCount,frames,1.f,channels);
+	else
+	if(bytesPerSample==4)
+		Convert::deinterleave((const int32_t *)in,channelCount,frames,1.f/65536,channels);
+	else
+	{
+		std::size_t n=std::size_t(frames)*channelCount;
+		if(buffer.size()<n)
+			buffer.resize(n);
+		for(std::size_t i=0;i<n;i++)
+		{
+			const unsigned char * s=in+3*i;
+			int32_t v=int32_t(uint32_t(s[0])<<8 | uint32_t(s[1])<<16 | uint32_t(s[2])<<24)>>8;
+			buffer[i]=float(v)*(1.f/256);
+		}
+		Convert::deinterleave(&buffer[0],channelCount,frames,1.f,channels);
+	}
+
+	position+=frames;
+	release();
+	return frames;
+}
+
+std::size_t MappedWave::skip(std::size_t frames)
+{
+	if(frames>frameCount-position)
+		frames=frameCount-position;
+	position+=frames;
+	return frames;
+}
+
+bool MappedWave::share(ShortChannels & target,std::size_t skip,std::size_t length)
+{
+	if(mapping==0 || channelCount!=1 || bytesPerSample!=2 || isFloat)
+		return false;
+
+	std::size_t first=position+skip<frameCount ? position+skip : frameCount;
+	std::size_t count=frameCount-first;
+	if(count>length)
+		count=length;
+
+	LOG(logDEBUG) << "Sharing " << count << " samples with the file" << std::endl;
+	std::shared_ptr<SampleBuffer> buffer=std::make_shared<SampleBuffer>(fd,dataOffset+2*first,2*count);
+	if(buffer->size()!=2*count)
+		return false;
+	target.push_back(ShortChannel(rate,buffer));
+	position=first+count;
+	return true;
+}
+
+void MappedWave::release()
+{
+#ifdef MADV_DONTNEED
+	std::size_t page=sysconf(_SC_PAGESIZE);
+	std::size_t end=dataOffset+position*channelCount*bytesPerSample;
+	end-=end%page;
+	if(end>=released+releaseStep)
+	{
+		madvise((void *)(mapping+released),end-released,MADV_DONTNEED);
+		released=end;
+	}
+#endif
+}
@@ -0,0 +1,108 @@
+/**
+ * @file		MappedWave.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Memory mapped reading of uncompressed wave files
+ */
+
+#ifndef MAPPEDWAVE_H_
+#define MAPPEDWAVE_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "AudioSource.h"
+
+/**
+ * @brief Audio source reading uncompressed WAV and RF64 files from a memory
+ * mapping
+ *
+ * The file is mapped instead of read, so the samples are converted directly
+ * from the page cache into the channels without the buffered reads of
+ * libsndfile. The mapping is advised for sequential access and pages are
+ * released behind the read position, so even huge archival files only
+ * occupy the currently converted pages. Skipping is free.
+ *
+ * Only mono 16 bit files loaded into ShortChannels are not converted at
+ * all: share() presents the samples of the file directly as a channel,
+ * which only reads the pages on access and copies the pages it modifies.
+ * Float channels, as used by the filters, --analyze and --plot, always
+ * hold a converted copy of all samples, and the inputs of the production
+ * are converted to float right after loading.
+ *
+ * Integer PCM with 16, 24 or 32 bit and 32 bit float samples are supported
+ * on little endian machines. For all other files good() is false and the
+ * file should be read with SndfileSource.
+ */
+class MappedWave : public AudioSource
+{
+	int						fd;
+	const unsigned char *	mapping;
+	std::size_t				mappingSize;
+	std::size_t				dataOffset;
+	std::size_t				frameCount;
+	std::size_t				position;
+	std::size_t				released;
+	unsigned				rate;
+	unsigned				channelCount;
+	unsigned				bytesPerSample;
+	bool					isFloat;
+	std::vector<float>		buffer;
+public:
+	/**
+	 * Map a file and parse its header
+	 * @param name file system name of file
+	 */
+	explicit MappedWave(const std::string & name);
+	virtual ~MappedWave();
+
+	virtual bool     good() const { return mapping!=0; }
+	virtual unsigned channels() const { return channelCount; }
+	virtual unsigned samplerate() const { return rate; }
+	virtual std::size_t frames() const;
+	virtual unsigned read(float * const * channels,unsigned frames);
+	using AudioSource::read;
+
+	/**
+	 * Skip frames by moving the read position
+	 * @param frames number of frames to skip
+	 * @return number of skipped frames
+	 */
+	virtual std::size_t skip(std::size_t frames);
+
+	/**
+	 * Append the samples of a mono 16 bit file as channel sharing the file
+	 * data, without reading the file
+	 * @param target channels to append the channel to
+	 * @param skip   number of frames to skip
+	 * @param length maximum number of frames after skip
+	 * @return false if the file has another format
+	 */
+	bool share(ShortChannels & target,std::size_t skip=0,std::size_t length=~std::size_t(0));
+
+	/**
+	 * Float channels cannot share the file data
+	 * @return false
+	 */
+	bool share(Channels &,std::size_t=0,std::size_t=~std::size_t(0)) { return false; }
+
+private:
+	MappedWave(const MappedWave &);
+	MappedWave & operator =(const MappedWave &);
+
+	/**
+	 * Parse the RIFF or RF64 header and locate the sample data
+	 * @return false if the format is not supported
+	 */
+	bool parse();
+
+	/**
+	 * Release the pages before the read position from the mapping
+	 */
+	void release();
+};
+
+#endif /* MAPPEDWAVE_H_ */
@@ -10,6 +10,7 @@
 #include <math.h>
 
 #include "Maximizer.h"
+#include "FrameBuffer.h"
 #include "Log.h"
 
 double Maximizer::expander(float c,float factor,int order) // Sigmoid-Funktion
@@ -51,59 +52,88 @@ double Maximizer::expanderDenoiser(float c,float factor,float minlevel,int order
 
 void Maximizer::amplify(Channel &c,float factor,int order)
 {
-	for(unsigned i=0;i<c.size();i++)
-		c[i]=expander(c[i],factor,order);
+	Span<float> s=c.span();
+	for(std::size_t i=0;i<s.size();i++)
+		s[i]=expander(s[i],factor,order);
 }
 
 void Maximizer::amplify(Channels &c,float factor,int order)
 {
 	unsigned samplerate=0;
-	unsigned length=0;
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 		if(c[i].samplerate()>samplerate)
 			samplerate=c[i].samplerate();
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 		if(c[i].samplerate()!=samplerate)
-			c[i]=c[i].resampleTo(samplerate);
+			c[i].resample(samplerate);
 
-	for(unsigned i=0;i<c.size();i++)
+	std::size_t length=0;
+	for(std::size_t i=0;i<c.size();i++)
 		if(c[i].size()>length)
 			length=c[i].size();
 
-	for(unsigned j=0;j<length;j++)
+	FrameBuffer f(samplerate,c.size(),FrameBuffer::blockFrames);
+	float localfactor[FrameBuffer::blockFrames];
+
+	for(std::size_t first=0;first<length;first+=FrameBuffer::blockFrames)
 	{
-		float localfactor=factor;
-		for(unsigned i=0;i<c.size();i++)
+		f.load(c,first);
+		unsigned n=length-first<FrameBuffer::blockFrames?length-first:FrameBuffer::blockFrames;
+		for(unsigned j=0;j<n;j++)
+			localfactor[j]=factor;
+		for(unsigned i=0;i<f.channels();i++)
+		{
+			Span<float> s=f.segment(i,0);
+			for(unsigned j=0;j<n;j++)
+				if(s[j]!=0)
+				{
+					float g=expander(s[j],factor,order)/s[j];
+					if(g<localfactor[j])
+						localfactor[j]=g;
+				}
+		}
+		for(unsigned i=0;i<f.channels();i++)
 		{
-			if(c[i][j]!=0)
-			{
-				float f=expander(c[i][j],factor,order)/c[i][j];
-				if(f<localfactor)
-					localfactor=f;
-			}
+			Span<float> s=f.segment(i,0);
+			for(unsigned j=0;j<n;j++)
+				s[j]*=localfactor[j];
 		}
-		for(unsigned i=0;i<c.size();i++)
-			c[i][j]*=localfactor;
+		f.store(c,first);
 	}
 }
 
+void Maximizer::amplifyFrame(float * frame,unsigned channels,float factor,int order)
+{
+	float localfactor=factor;
+	for(unsigned i=0;i<channels;i++)
+		if(frame[i]!=0)
+		{
+			float g=expander(frame[i],factor,order)/frame[i];
+			if(g<localfactor)
+				localfactor=g;
+		}
+	for(unsigned i=0;i<channels;i++)
+		frame[i]*=localfactor;
+}
+
 void Maximizer::amplifyDenoise(Channel &c,float factor,float minlevel,int order)
 {
-	for(unsigned i=0;i<c.size();i++)
-		c[i]=expanderDenoiser(c[i],factor,minlevel,order);
+	Span<float> s=c.span();
+	for(std::size_t i=0;i<s.size();i++)
+		s[i]=expanderDenoiser(s[i],factor,minlevel,order);
 }
 
 void Maximizer::amplifyDenoise(Channels &c,float factor,float minlevel,int order)
 {
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 		amplifyDenoise(c[i],factor,minlevel,order);
 }
 
 void Maximizer::normalize(Channels & c,float level)
 {
 	float max=1e-10;
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 	{
 		float e=c[i].linfnorm();
 		if(e>max)
@@ -114,23 +144,28 @@ void Maximizer::normalize(Channels & c,float level)
 	{
 		float factor=level/max;
 
-		for(unsigned i=0;i<c.size();i++)
-			for(unsigned j=0;j<c[i].size();j++)
-				c[i][j]*=factor;
+		for(std::size_t i=0;i<c.size();i++)
+		{
+			Span<float> s=c[i].span();
+			for(std::size_t j=0;j<s.size();j++)
+				s[j]*=factor;
+		}
 	}
 }
 
 void Maximizer::normalize(Channel & c,float level)
 {
 	float max=1e-10;
-	for(unsigned i=0;i<c.size();i++)
-		if(fabs(c[i])>max)
-			max=fabs(c[i]);
+	Span<const float> v=c.view();
+	for(std::size_t i=0;i<v.size();i++)
+		if(fabs(v[i])>max)
+			max=fabs(v[i]);
 
 	if(max!=level)
 	{
 		float factor=level/max;
-		for(unsigned i=0;i<c.size();i++)
-			c[i]*=factor;
+		Span<float> s=c.span();
+		for(std::size_t i=0;i<s.size();i++)
+			s[i]*=factor;
 	}
 }
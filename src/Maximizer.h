@@ -46,6 +46,16 @@ public:
 	 */
 	static void amplify(Channels &channels,float factor,int order=4);
 
+	/**
+	 * Multiplication of a single frame by constant factor and soft limiting
+	 * of the loudest sample, as in amplify(Channels&,float,int). Used for
+	 * limiting within the final sweep of a Pipeline.
+	 * @param frame    samples of all channels at one point in time
+	 * @param channels number of samples in frame
+	 * @param factor   factor
+	 * @param order    of sigmoid function
+	 */
+	static void amplifyFrame(float * frame,unsigned channels,float factor,int order=4);
 
 	/**
 	 * Multiplication of signal by constant factor and soft limiting by
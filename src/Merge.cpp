@@ -7,13 +7,15 @@
  * @brief       Merging of audio segments either with overlap or fading
  */
 
+#include <algorithm>
+
 #include "Merge.h"
 #include "Log.h"
 
 Channels Merge::overlap(Channels &a,Channels &b,float sec)
 {
 	unsigned samplerate=unifySamplerate(a,b);
-	unsigned overlap=sec*samplerate;
+	std::size_t overlap=sec*samplerate;
 	//Channels target(a);
 	if(a.size()==0)
 		return b;
@@ -27,18 +29,21 @@ Channels Merge::overlap(Channels &a,Channels &b,float sec)
 
 	Channels target(a);
 
-	for(unsigned i=0;i<a.size();i++)
+	for(std::size_t i=0;i<a.size();i++)
 	{
-		unsigned fs=a[i].size()+b[i].size()-overlap;
+		std::size_t fs=a[i].size()+b[i].size()-overlap;
 		target[i]=Channel(samplerate,a[i].size()+b[i].size()-overlap);
-		unsigned j;
-		unsigned as=a[0].size();
-		for(j=0;j<as-overlap;j++)
-			target[i][j]=a[i][j];
-		for(;j<as;j++)
-			target[i][j]=a[i][j]+b[i][j-(as-overlap)];
-		for(;j<fs;j++)
-			target[i][j]=b[i][j-(as-overlap)];
+		std::size_t as=a[0].size();
+		long offset=long(as)-long(overlap);
+		Span<float> t=target[i].span();
+		Span<const float> sa=a[i].view().sub(0,std::min(as,fs));
+		Span<const float> sb=b[i].view().sub(std::max(-offset,0L),fs);
+		float * tb=t.data()+std::min(std::max(offset,0L),(long)t.size());
+
+		for(std::size_t j=0;j<sa.size();j++)
+			t[j]=sa[j];
+		for(std::size_t k=0;k<sb.size() && tb+k<t.end();k++)
+			tb[k]+=sb[k];
 	}
 	return target;
 }
@@ -46,7 +51,7 @@ Channels Merge::overlap(Channels &a,Channels &b,float sec)
 Channels Merge::fade(Channels &a,Channels &b,float sec)
 {
 	unsigned samplerate=unifySamplerate(a,b);
-	unsigned overlap=sec*samplerate;
+	std::size_t overlap=sec*samplerate;
 
 	if(a.size()==0)
 		return a;
@@ -59,21 +64,32 @@ Channels Merge::fade(Channels &a,Channels &b,float sec)
 
 	Channels target(a);
 
-	for(unsigned i=0;i<a.size();i++)
+	for(std::size_t i=0;i<a.size();i++)
 	{
-		unsigned fs=a[i].size()+b[i].size()-overlap;
+		std::size_t fs=a[i].size()+b[i].size()-overlap;
 		target[i]=Channel(samplerate,a[i].size()+b[i].size()-overlap);
-		unsigned j;
-		unsigned as=a[0].size();
-		for(j=0;j<as-overlap;j++)
-			target[i][j]=a[i][j];
-		for(;j<as;j++)
+		std::size_t j;
+		std::size_t as=a[0].size();
+		long offset=long(as)-long(overlap);
+		std::size_t cross=std::max(offset,0L);
+		Span<float> t=target[i].span();
+		Span<const float> sa=a[i].view().sub(0,std::min(as,fs));
+		Span<const float> sb=b[i].view();
+
+		for(j=0;j<cross && j<sa.size();j++)
+			t[j]=sa[j];
+		for(;j<sa.size();j++)
+		{
+			float f=float(as-j)/overlap;
+			t[j]=sa[j]*f;
+		}
+		for(j=cross;j<as && j<t.size() && std::size_t(j-offset)<sb.size();j++)
 		{
 			float f=float(as-j)/overlap;
-			target[i][j]=a[i][j]*f+b[i][j-(as-overlap)]*(1-f);
+			t[j]+=sb[j-offset]*(1-f);
 		}
-		for(;j<fs;j++)
-			target[i][j]=b[i][j-(as-overlap)];
+		for(;j<t.size() && std::size_t(j-offset)<sb.size();j++)
+			t[j]+=sb[j-offset];
 	}
 	return target;
 }
@@ -82,15 +98,15 @@ Channels Merge::parallel(Channels &a, Channels &b)
 {
 	unifySamplerate(a,b);
 	Channels target(a);
-	for(unsigned i=0;i<a.size();i++)
+	for(std::size_t i=0;i<a.size();i++)
 	{
-		unsigned offset=0;
+		std::size_t offset=0;
 		if(a[i].size()>b[i].size())
 			offset=a[i].size()-b[i].size();
-		for(unsigned j=0;j<offset;j++)
-			target[i][j]=a[i][j];
-		for(unsigned j=offset;j<a[i].size();j++)
-			target[i][j]=a[i][j]+b[i][j-offset];
+		Span<float> t=target[i].span();
+		Span<const float> sb=b[i].view();
+		for(std::size_t j=offset;j<t.size();j++)
+			t[j]+=sb[j-offset];
 	}
 
 	return target;
@@ -105,21 +121,21 @@ int Merge::unifySamplerate(Channels &a,Channels &b)
 		a.push_back(Channel(1));
 
 	unsigned freq=1;
-	for(unsigned i=0;i<a.size();i++)
+	for(std::size_t i=0;i<a.size();i++)
 		if(a[i].samplerate()>freq)
 			freq=a[i].samplerate();
 
-	for(unsigned i=0;i<b.size();i++)
+	for(std::size_t i=0;i<b.size();i++)
 		if(b[i].samplerate()>freq)
 			freq=b[i].samplerate();
 
-	for(unsigned i=0;i<a.size();i++)
+	for(std::size_t i=0;i<a.size();i++)
 		if(a[i].samplerate()!=freq)
-			a[i]=a[i].resampleTo(freq);
+			a[i].resample(freq);
 
-	for(unsigned i=0;i<b.size();i++)
+	for(std::size_t i=0;i<b.size();i++)
 		if(b[i].samplerate()!=freq)
-			b[i]=b[i].resampleTo(freq);
+			b[i].resample(freq);
 
 	return freq;
 }
@@ -18,18 +18,18 @@ void MonoMix::mix(Channel &c,float factor)
 {
 	if(target[0].size()==0 || c.samplerate()>target[0].samplerate())
 	{
-		target[0]=target[0].resampleTo(c.samplerate());
+		target[0].resample(c.samplerate());
 		LOG(logDEBUG) << "Target samplerate set to " << c.samplerate() << std::endl;
 	}
 	if(c.samplerate()<target[0].samplerate())
-		c.resampleTo(target[0].samplerate());
+		c.resample(target[0].samplerate());
 	if(target[0].size()<c.size())
 	{
-		target[0]=target[0].resizeTo(c.size());
+		target[0].resize(c.size());
 		LOG(logDEBUG) << "Target size set to " << c.size()/c.samplerate() << "s"<< std::endl;
 	}
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 		target[0][i]+=factor*c[i];
 }
 
@@ -38,6 +38,26 @@ void MonoMix::mix(Channels &c)
 	if(c.size()==0)
 		return;
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 		mix(c[i]);
 }
+
+void MonoMix::mix(Pipeline &p)
+{
+	if(p.channels()==0)
+		return;
+
+	if(!p.uniform() ||
+	   (target[0].size()!=0 && target[0].samplerate()!=p.input()[0].samplerate()))
+	{
+		p.apply();
+		mix(p.input());
+		p.finish(target);
+		return;
+	}
+
+	Pipeline::MixMatrix matrix(1);
+	for(unsigned i=0;i<p.channels();i++)
+		matrix[0].push_back(Pipeline::Tap(i,1.0));
+	p.mix(matrix,target);
+}
@@ -11,6 +11,7 @@
 #define MONOMIX_H_
 
 #include "Channel.h"
+#include "Pipeline.h"
 
 /**
  * @brief Create mono mix-down
@@ -35,6 +36,13 @@ public:
 	 */
 	void        mix(Channels &c);
 
+	/**
+	 * Mix the channels of a pipeline into the mix-down, applying pending
+	 * gains and the limiter of the pipeline in the same sweep
+	 * @param p			Pipeline on the channels
+	 */
+	void        mix(Pipeline &p);
+
 	/**
 	 * Return current mono mix-down
 	 * @return mix-down Channel
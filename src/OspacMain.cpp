@@ -8,6 +8,7 @@
  */
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "OspacMain.h"
@@ -26,6 +27,12 @@
 #include "Frequency.h"
 #include "Analyzer.h"
 #include "Encode.h"
+#include "SampleBuffer.h"
+#include "BufferPool.h"
+#include "Pipeline.h"
+#include "InputQueue.h"
+#include "OutputQueue.h"
+#include "DecodeCache.h"
 #include <stdlib.h>
 
 
@@ -46,16 +53,18 @@
  *
  * A main issue is to get things done without too much hassle. Therefore, the
  * external dependencies are minimal: It depends on libsndfile only. Also,
- * the channels are simply std::vectors of floats, therefore all is done in
- * memory and unnecessary copy operations will take place. Furthermore,
+ * the channels are simply arrays of floats, which are kept in memory or, above
+ * a given memory limit, in memory mapped temporary files. The sample data is
+ * shared between copies of channels and only copied when it is modified
+ * (copy-on-write). Furthermore,
  * there is not yet an object oriented concept of generators, analyzers,
  * filters, and consumers, and thus many filters are just static methods
  * getting their thing done.
  *
  * @subsection Fundamentals Fundamental classes
  *
- * Single channels are represented by the Channel class. It consists of
- * std::vector<float> and the corresponding bitrate. Multiple channels such
+ * Single channels are represented by the Channel class. It consists of a
+ * reference counted SampleBuffer and the corresponding bitrate. Multiple channels such
  * as in stereo are represented by Channels, a std::vector<Channel>.
  *
  * Loading and saving of Channels is done by the Wave class. It uses
@@ -237,12 +246,6 @@
  * Most of the filters can easily benefit from multi threading- either by
  * parallel treatment of channels, or by time splitting in a channel for
  * filters that do not have time-dependent side-effects.
- *
- * <strong>Channel virtualization</strong>
- *
- * To avoid excessive memory usage, the basic channel structure could be
- * extended to support hard drive mapping of results. Only segments that
- * are currently worked on are in memory and all other parts remain on disc.
  */
 
 
@@ -252,10 +255,12 @@ OspacMain::OspacMain(std::vector<std::string> aArg) : arg(aArg),
 		  comment("Encoded by ospac.net"),
 		  category("Speech"),episode(""),
 		  year(""),image(""),
-		  quality(Encode::STANDARD)
+		  quality(Encode::STANDARD),
+		  waveFormat(Wave::PCM16)
 {
 	mixMode=STEREO;
 	argMode=VOICE;
+	planning=false;
 	nextTransitionMode=transitionMode=NONE;
 	nextTransitionSeconds=transitionSeconds=0;
 
@@ -303,6 +308,14 @@ OspacMain::OspacMain(std::vector<std::string> aArg) : arg(aArg),
 	stereoSpatial=0.03;
 
 	setStandard();
+
+	// planning affects all inputs and stages, wherever it is given
+	for(unsigned i=0;i<arg.size();i++)
+	{
+		std::string o(arg[i]);
+		if(isOption(o) && o=="plan")
+			planning=true;
+	}
 }
 
 void OspacMain::setStandard()
@@ -354,6 +367,7 @@ std::string OspacMain::options[]={"spatial","stereo","mono","multi",
 							  "set-stereo-level","set-stereo-spatial",
 							  "voice","mix","raw",
 							  "ascii","left","right","to-mono",
+							  "load-skip","load-length",
 							  "fade","overlap","parallel",
 							  "factor", "no-factor",
 							  "leveler","no-leveler","target","level-mode",
@@ -366,11 +380,12 @@ std::string OspacMain::options[]={"spatial","stereo","mono","multi",
 							  "eqvoice","no-eqvoice",
 							  "bandpass", "lowpass", "highpass",
 							  "analyze",
-							  "output","mp3","ogg",
+							  "output","mp3","ogg","flac","opus",
 							  "title","artist","album",
 							  "comment","category","episode",
-							  "year","image","quality",
-							  "help","verbosity","plot"
+							  "year","image","quality","bits",
+							  "help","verbosity","plot",
+							  "max-memory","cache","cache-size","plan"
 #ifdef HAS_FFMPEG
 							  ,"aac","bitrate"
 #endif
@@ -378,14 +393,29 @@ std::string OspacMain::options[]={"spatial","stereo","mono","multi",
 
 int OspacMain::run(void)
 {
+	// recycle the storage of temporary channels of all segments
+	BufferPool pool;
+
 	Channels operand;
 	Channels work;
 
+	// inputs are decoded concurrently once another option needs them
+	InputQueue inputs;
+
+	// outputs are written concurrently until another option follows them
+	OutputQueue outputs;
+
 	for(unsigned i=0;i<arg.size();i++)
 	{
 		if(isOption(arg[i]))
 		{
 			LOG(logDEBUG) << "Option: --" << arg[i] << std::endl;
+			if(arg[i]!="ascii" && arg[i]!="left" && arg[i]!="right" && arg[i]!="to-mono"
+			   && arg[i]!="load-skip" && arg[i]!="load-length"
+			   && !(planning ? inputs.probe(projection) : inputs.load(work)))
+				return 2;
+			if(!isOutputOption(arg[i]))
+				outputs.write();
 			if(arg[i]=="help")
 			{
 				std::cout << std::endl;
@@ -400,6 +430,12 @@ int OspacMain::run(void)
 				std::cout << " Information:" << std::endl;
 				std::cout << "  --help          This information" << std::endl;
 				std::cout << "  --verbosity [n] Set verbosity to level [n]" << std::endl;
+				std::cout << "  --plan          Project memory and cost of all stages without processing" << std::endl;
+				std::cout << std::endl;
+				std::cout << " Resources:" << std::endl;
+				std::cout << "  --max-memory [n] Keep at most [n] MB of samples in memory, spill the rest to temporary files" << std::endl;
+				std::cout << "  --cache [dir]   Cache decoded compressed inputs in directory [dir]" << std::endl;
+				std::cout << "  --cache-size [n] Keep at most [n] MB of decoded inputs in the cache (2048)" << std::endl;
 				std::cout << std::endl;
 				std::cout << " Output modes:" << std::endl;
 				std::cout << "  --spatial       Create 3d stereo with interaural delays"<< std::endl;
@@ -412,12 +448,13 @@ int OspacMain::run(void)
 				std::cout << std::endl;
 				std::cout << " Output targets:" << std::endl;
 				std::cout << "  --output [file] Write final output to [file] in wave format" << std::endl;
+				std::cout << "  --bits [n]      Bits per sample of wave output: 16, 24 or 32 (float)" << std::endl;
 				std::cout << "  --plot [file]   Write final output to [file] in netpbm format" << std::endl;
 				std::cout << "  --mp3 [file]    Write final output to [file] using external lame" << std::endl;
 				std::cout << "  --ogg [file]    Write final output to [file] using external oggenc" << std::endl;
 				std::cout << "  --quality [n]   Quality from 0-low, 1-standard, 2-high, 3-insane" << std::endl;
 				#ifdef HAS_FFMPEG
-				std::cout << "  --aac [file]    Write final output to [file] in aac format" << std::endl;
+				std::cout << "  --aac [file]    Write final output to [file] in aac format (m4a or .aac)" << std::endl;
 				std::cout << "  --bitrate [n]   Bitrate to use for aac output in kbit/s (default:64)"<<std::endl;
 				#endif
 				std::cout << std::endl;
@@ -478,6 +515,8 @@ int OspacMain::run(void)
 				std::cout << "  --right [file]  Load right channel of wave file (if stereo)" << std::endl;
 				std::cout << "  --to-mono [file] Load mono-mixdown of wave file (if stereo)" << std::endl;
 				std::cout << "  --ascii [s] [file] Load ascii wave file with sample rate s" << std::endl;
+				std::cout << "  --load-skip [s] Skip first s seconds of following inputs" << std::endl;
+				std::cout << "  --load-length [s] Load at most s seconds of following inputs" << std::endl;
 				std::cout << std::endl;
 				std::cout << "Examples:" << std::endl;
 				std::cout << " Mix 2 mono voice recordings with crossgate, leveling and normalization:" << std::endl;
@@ -534,11 +573,57 @@ int OspacMain::run(void)
 
 				LOG(logINFO) << "Setting loglevel to " << Log::getLoglevel() << std::endl;
 			} else
+			if(arg[i]=="max-memory")
+			{
+				if(i+1<arg.size())
+				{
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+					double megabytes=atof(arg[i].c_str());
+					if(megabytes<0)
+						megabytes=0;
+					SampleBuffer::setMemoryLimit(std::size_t(megabytes*1024*1024));
+					LOG(logINFO) << "Setting memory limit to " << megabytes << "MB" << std::endl;
+				}
+			} else
+			if(arg[i]=="cache")
+			{
+				if(i+1<arg.size())
+				{
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+					DecodeCache::setDirectory(arg[i]);
+				}
+			} else
+			if(arg[i]=="cache-size")
+			{
+				if(i+1<arg.size())
+				{
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+					double megabytes=atof(arg[i].c_str());
+					if(megabytes<0)
+						megabytes=0;
+					DecodeCache::setLimit(std::size_t(megabytes*1024*1024));
+					LOG(logINFO) << "Setting cache size limit to " << megabytes << "MB" << std::endl;
+				}
+			} else
+			if(arg[i]=="plan")
+			{
+				LOG(logINFO) << "Projecting memory and cost without processing samples" << std::endl;
+				planning=true;
+			} else
 			if(arg[i]=="plot")
 			{
 				if(target.size()==0)
 					render(work,operand,target);
 
+				if(planning)
+				{
+					if(i+1<arg.size())
+						i++;
+					projection.stage("plot",0,Plan::samples(projection.target));
+				} else
 				if(i+1<arg.size())
 				{
 					i++;
@@ -882,7 +967,19 @@ int OspacMain::run(void)
 					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
 					LOG(logDEBUG) << "nextMode: " << nextTransitionMode << " Mode: " << transitionMode << std::endl;
 
-					Wave::save(arg[i],target);
+					if(planning)
+					{
+						projection.stage("output "+arg[i],0,Plan::samples(projection.target)*2);
+						continue;
+					}
+
+					std::shared_ptr<Channels> channels=std::make_shared<Channels>(target);
+					std::string name=arg[i];
+					Wave::SampleFormat format=waveFormat;
+					outputs.add(name,[channels,name,format]()
+					{
+						return Wave::save(name,*channels,format);
+					});
 				}
 			} else
 			if(arg[i]=="mp3")
@@ -895,7 +992,15 @@ int OspacMain::run(void)
 					i++;
 					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
 
-					int result=Encode(target)
+					if(planning)
+					{
+						projection.stage("mp3 "+arg[i],Plan::bytes(projection.target)/2,
+								         Plan::samples(projection.target)*30);
+						continue;
+					}
+
+					std::shared_ptr<Channels> channels=std::make_shared<Channels>(target);
+					Encode encode=Encode(*channels)
 									.Title(title)
 									.Artist(artist)
 									.Comment(comment)
@@ -903,12 +1008,12 @@ int OspacMain::run(void)
 									.Episode(episode)
 									.Year(year)
 									.Image(image)
-									.Quality(quality)
-									.mp3(arg[i]);
-					if(result)
+									.Quality(quality);
+					std::string name=arg[i];
+					outputs.add(name,[channels,encode,name]() mutable
 					{
-						LOG(logDEBUG) << "Encoding failed with error code " << result;
-					}
+						return encode.mp3(name);
+					});
 				}
 			} else
 			if(arg[i]=="ogg")
@@ -921,7 +1026,15 @@ int OspacMain::run(void)
 					i++;
 					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
 
-					int result=Encode(target)
+					if(planning)
+					{
+						projection.stage("ogg "+arg[i],Plan::bytes(projection.target)/2,
+								         Plan::samples(projection.target)*30);
+						continue;
+					}
+
+					std::shared_ptr<Channels> channels=std::make_shared<Channels>(target);
+					Encode encode=Encode(*channels)
 									.Title(title)
 									.Artist(artist)
 									.Comment(comment)
@@ -929,13 +1042,67 @@ int OspacMain::run(void)
 									.Episode(episode)
 									.Year(year)
 									.Image(image)
-									.Quality(quality)
-									.ogg(arg[i]);
-					if(result)
+									.Quality(quality);
+					std::string name=arg[i];
+					outputs.add(name,[channels,encode,name]() mutable
+					{
+						return encode.ogg(name);
+					});
+				}
+			} else
+			if(arg[i]=="flac" || arg[i]=="opus")
+			{
+				if(target.size()==0)
+					render(work,operand,target);
+
+				if(i+1<arg.size())
+				{
+					std::string format=arg[i];
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+
+					if(planning)
 					{
-						LOG(logDEBUG) << "Encoding failed with error code " << result;
+						projection.stage(format+" "+arg[i],0,
+								         Plan::samples(projection.target)*(format=="flac" ? 10 : 30));
+						continue;
 					}
 
+					std::shared_ptr<Channels> channels=std::make_shared<Channels>(target);
+					Encode encode=Encode(*channels)
+									.Title(title)
+									.Artist(artist)
+									.Comment(comment)
+									.Album(album)
+									.Episode(episode)
+									.Year(year)
+									.Quality(quality);
+					std::string name=arg[i];
+					outputs.add(name,[channels,encode,name,format]() mutable
+					{
+						return format=="flac" ? encode.flac(name) : encode.opus(name);
+					});
+				}
+			} else
+			if(arg[i]=="bits")
+			{
+				if(i+1<arg.size())
+				{
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+					switch(atoi(arg[i].c_str()))
+					{
+					case 24:
+						waveFormat=Wave::PCM24;
+						break;
+					case 32:
+						waveFormat=Wave::FLOAT32;
+						break;
+					case 16:
+					default:
+						waveFormat=Wave::PCM16;
+						break;
+					}
 				}
 			} else
 			if(arg[i]=="quality")
@@ -974,13 +1141,21 @@ int OspacMain::run(void)
 					i++;
 					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
 
-					int result=Encode(target)
-									.Bitrate(aacBitrate)
-									.aac(arg[i]);
-					if(result)
+					if(planning)
 					{
-						LOG(logDEBUG) << "Encoding failed with error code " << result;
+						projection.stage("aac "+arg[i],Plan::bytes(projection.target)/2,
+								         Plan::samples(projection.target)*30);
+						continue;
 					}
+
+					std::shared_ptr<Channels> channels=std::make_shared<Channels>(target);
+					Encode encode=Encode(*channels)
+									.Bitrate(aacBitrate);
+					std::string name=arg[i];
+					outputs.add(name,[channels,encode,name]() mutable
+					{
+						return encode.aac(name);
+					});
 				}
 			} else
 			if(arg[i]=="bitrate")
@@ -1070,8 +1245,12 @@ int OspacMain::run(void)
 				if(target.size()==0)
 					render(work,operand,target);
 
-				for(unsigned c=0;c<target.size();c++)
-					Analyzer::bandedAnalysis(target[c]);
+				if(planning)
+					projection.stage("analyze",Plan::largest(projection.target)*2,
+							         Plan::samples(projection.target)*20);
+				else
+					for(unsigned c=0;c<target.size();c++)
+						Analyzer::bandedAnalysis(target[c]);
 			} else
 			if(arg[i]=="ascii")
 			{
@@ -1085,27 +1264,36 @@ int OspacMain::run(void)
 					if(i+1<arg.size())
 					{
 						i++;
-						unsigned before=work.size();
-						Wave::loadAscii(arg[i],samplerate,work,loadSkipSeconds,loadMaxSeconds);
-						if(work.size()==before)
-						{
-							LOG(logERROR) << "Could not load " << arg[i] << std::endl;
-							return 2;
-						}
+						inputs.add(arg[i],InputQueue::ASCII,loadSkipSeconds,loadMaxSeconds,samplerate);
 					}
 				}
 
 			} else
+			if(arg[i]=="load-skip")
+			{
+				if(i+1<arg.size())
+				{
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+					loadSkipSeconds=atof(arg[i].c_str());
+				}
+			} else
+			if(arg[i]=="load-length")
+			{
+				if(i+1<arg.size())
+				{
+					i++;
+					LOG(logDEBUG) << "Value: " << arg[i] << std::endl;
+					loadMaxSeconds=atof(arg[i].c_str());
+				}
+			} else
 			if(arg[i]=="left")
 			{
 				if(i+1<arg.size())
 				{
 					i++;
 					target=Channels();
-					Channels temp;
-					Wave::load(arg[i],temp,loadSkipSeconds,loadMaxSeconds);
-					if(temp.size()>=1)
-						work.push_back(temp[0]);
+					inputs.add(arg[i],InputQueue::LEFT,loadSkipSeconds,loadMaxSeconds);
 				}
 			} else
 			if(arg[i]=="right")
@@ -1114,13 +1302,7 @@ int OspacMain::run(void)
 				{
 					i++;
 					target=Channels();
-					Channels temp;
-					Wave::load(arg[i],temp,loadSkipSeconds,loadMaxSeconds);
-					if(temp.size()==1)
-						work.push_back(temp[0]);
-					if(temp.size()>1)
-						work.push_back(temp[1]);
-
+					inputs.add(arg[i],InputQueue::RIGHT,loadSkipSeconds,loadMaxSeconds);
 				}
 			} else
 			if(arg[i]=="to-mono")
@@ -1129,16 +1311,7 @@ int OspacMain::run(void)
 				{
 					i++;
 					target=Channels();
-					Channels temp;
-					Wave::load(arg[i],temp,loadSkipSeconds,loadMaxSeconds);
-					if(temp.size()==1)
-						work.push_back(temp[0]);
-					if(temp.size()>1)
-					{
-						MonoMix mix;
-						mix.mix(temp);
-						work.push_back(mix.getTarget()[0]);
-					}
+					inputs.add(arg[i],InputQueue::MONO,loadSkipSeconds,loadMaxSeconds);
 				}
 			} else
 			{
@@ -1147,21 +1320,20 @@ int OspacMain::run(void)
 			}
 		} else
 		{
+			outputs.write();
 			target=Channels();
-			unsigned before=work.size();
-			#ifdef HAS_FFMPEG
-			Wave::loadFfmpeg(arg[i],work);
-			#else
-			Wave::load(arg[i],work,loadSkipSeconds,loadMaxSeconds);
-			#endif
-			if(work.size()==before)
-			{
-				LOG(logERROR) << "Could not load " << arg[i] << std::endl;
-				return 2;
-			}
+			inputs.add(arg[i],InputQueue::ALL,loadSkipSeconds,loadMaxSeconds);
 		}
 	}
 
+	outputs.write();
+
+	if(!(planning ? inputs.probe(projection) : inputs.load(work)))
+		return 2;
+
+	if(planning)
+		projection.print(std::cout);
+
 	LOG(logINFO) << "finished" << std::endl;
 
 	return 0;
@@ -1169,6 +1341,15 @@ int OspacMain::run(void)
 
 void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 {
+	if(planning)
+	{
+		renderPlan(&target==&operand);
+		// the rendered target is only projected
+		if(&target!=&operand)
+			target=Channels(1);
+		return;
+	}
+
 	if(work.size()==0 || work[0].size()==0)
 	{
 		target=operand;
@@ -1181,7 +1362,7 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 	}
 	if(voiceEq)
 	{
-		work=Equalizer::voiceEnhance(work);
+		work=Equalizer::voiceEnhance(std::move(work));
 	}
 	if(lowpassTransition!=0)
 	{
@@ -1189,8 +1370,8 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		freqs[0]=lowpassFrequency;
 		for(unsigned c=0;c<work.size();c++)
 		{
-			Channels bands=Frequency::split(work[c],freqs,lowpassTransition,true);
-			work[c]=bands[0];
+			Channels bands=Frequency::split(std::move(work[c]),freqs,lowpassTransition,true);
+			work[c]=std::move(bands[0]);
 		}
 	}
 	if(highpassTransition!=0)
@@ -1199,8 +1380,8 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		freqs[0]=highpassFrequency;
 		for(unsigned c=0;c<work.size();c++)
 		{
-			Channels bands=Frequency::split(work[c],freqs,highpassTransition,true);
-			work[c]=bands[1];
+			Channels bands=Frequency::split(std::move(work[c]),freqs,highpassTransition,true);
+			work[c]=std::move(bands[1]);
 		}
 	}
 	if(bandpassTransition!=0)
@@ -1210,10 +1391,11 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		freqs[1]=bandpassHigh;
 		for(unsigned c=0;c<work.size();c++)
 		{
-			Channels bands=Frequency::split(work[c],freqs,bandpassTransition,true);
-			work[c]=bands[1];
+			Channels bands=Frequency::split(std::move(work[c]),freqs,bandpassTransition,true);
+			work[c]=std::move(bands[1]);
 		}
 	}
+	Pipeline pipeline(work);
 	if(xFilter)
 	{
 		LOG(logDEBUG) << "CrosstalkFilter" << std::endl;
@@ -1222,25 +1404,27 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		CrosstalkFilter ctFilter(work,3,0.66,0.5,3.0);
 		ctFilter.analyze();
 		//ctFilter.save("analysis.wav");
-		ctFilter.mute();
+		ctFilter.mute(pipeline);
 	}
 	if(xGate)
 	{
 		LOG(logDEBUG) << "CrosstalkGate" << std::endl;
 //		CrosstalkGate::gate(work,100,0.35);
-		CrosstalkGate::gate(work,100,1.0);
+		CrosstalkGate::gate(pipeline,100,1.0);
 	}
 	if(leveler)
 	{
 		LOG(logDEBUG) << "Leveler" << std::endl;
 
 		if(argMode==VOICE)
-			SelectiveLeveler::level(work,levelChannelMode,levelTarget,1.0,0.05,0.025,0.2,0.4);
+			SelectiveLeveler::level(pipeline,levelChannelMode,levelTarget,1.0,0.05,0.025,0.2,0.4);
 		else if(argMode==MIX && (work.size()%2)==0)
-			SelectiveLeveler::level(work,levelChannelMode,levelTarget,1.0,0.1,0.05,0.1,0.5);
+			SelectiveLeveler::level(pipeline,levelChannelMode,levelTarget,1.0,0.1,0.05,0.1,0.5);
 		else
-			SelectiveLeveler::level(work,levelChannelMode,levelTarget,1.0,0.05,0.025,0.2,0.4);
+			SelectiveLeveler::level(pipeline,levelChannelMode,levelTarget,1.0,0.05,0.025,0.2,0.4);
 	}
+	if(skip || noise)
+		pipeline.apply();
 	if(skip)
 	{
 		if(skipTarget==0)
@@ -1261,6 +1445,14 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		noise=false;
 	}
 
+	if(maximizer!=0.0)
+	{
+		LOG(logDEBUG) << "Maximizer" << std::endl;
+		pipeline.limit(maximizer);
+	}
+
+	// the mixers consume the pipeline and replace its source channels
+	bool mixed=false;
 	switch(mixMode)
 	{
 	case SPATIAL:
@@ -1268,8 +1460,9 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		{
 			LOG(logDEBUG) << "StereoMix" << std::endl;
 			StereoMix mix;
-			mix.mix(work,stereoLevel,true,stereoSpatial);
+			mix.mix(pipeline,stereoLevel,true,stereoSpatial);
 			work=mix.getTarget();
+			mixed=true;
 		}
 		break;
 	case STEREO:
@@ -1277,16 +1470,18 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 		{
 			LOG(logDEBUG) << "StereoMix" << std::endl;
 			StereoMix mix;
-			mix.mix(work,stereoLevel);
+			mix.mix(pipeline,stereoLevel);
 			work=mix.getTarget();
+			mixed=true;
 		}
 		break;
 	case MONO:
 		{
 			LOG(logDEBUG) << "MonoMix" << std::endl;
 			MonoMix mix;
-			mix.mix(work);
+			mix.mix(pipeline);
 			work=mix.getTarget();
+			mixed=true;
 		}
 		{
 			if(operand.size()>1)
@@ -1305,11 +1500,8 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 	default:
 		break;
 	}
-	if(maximizer!=0.0)
-	{
-		LOG(logDEBUG) << "Maximizer" << std::endl;
-		Maximizer::amplify(work,maximizer);
-	}
+	if(!mixed)
+		pipeline.render();
 	if(normalizer)
 	{
 		LOG(logDEBUG) << "Normalize" << std::endl;
@@ -1338,6 +1530,105 @@ void OspacMain::render(Channels & work,Channels & operand,Channels & target)
 	}
 }
 
+void OspacMain::renderPlan(bool intoOperand)
+{
+	Plan::Shapes & work=projection.work;
+	Plan::Shapes & operand=projection.operand;
+
+	projection.target.clear();
+	if(Plan::samples(work)==0)
+	{
+		if(intoOperand)
+			work.clear();
+		else
+			projection.target=operand;
+		return;
+	}
+
+	double samples=Plan::samples(work);
+	double longest=Plan::largest(work);
+
+	if(trim)
+		projection.stage("trim",0,samples);
+	if(voiceEq)
+		projection.stage("voice equalizer",6*longest,samples*40);
+	if(lowpassTransition!=0)
+		projection.stage("lowpass",3*longest,samples*10);
+	if(highpassTransition!=0)
+		projection.stage("highpass",3*longest,samples*10);
+	if(bandpassTransition!=0)
+		projection.stage("bandpass",4*longest,samples*20);
+	// each gain stage of the pipeline keeps a gain curve per channel
+	projection.pipeline=0;
+	if(xFilter)
+	{
+		projection.pipeline+=Plan::bytes(work);
+		projection.stage("crosstalk filter",Plan::bytes(work),samples*30);
+	}
+	if(xGate)
+	{
+		projection.pipeline+=Plan::bytes(work);
+		projection.stage("crosstalk gate",0,samples*8);
+	}
+	if(leveler)
+	{
+		projection.pipeline+=Plan::bytes(work);
+		projection.stage("leveler",0,samples*12);
+	}
+	if(skip || noise)
+		projection.pipeline=0;
+	if(skip)
+	{
+		projection.stage("skip silence",Plan::bytes(work),samples*4);
+		skip=false;
+	}
+	if(noise)
+	{
+		projection.stage("skip signal",0,samples*4);
+		noise=false;
+	}
+
+	Plan::Shape mixed={work[0].rate,0};
+	for(unsigned c=0;c<work.size();c++)
+		mixed.frames=std::max(mixed.frames,work[c].frames);
+
+	// the mixers apply the gains of the pipeline, otherwise they are applied in place
+	if(mixMode==MONO)
+	{
+		projection.stage("mono mix",longest,samples*2);
+		work=Plan::Shapes(1,mixed);
+		if(operand.size()>1)
+		{
+			projection.stage("late mono mix",Plan::largest(operand),Plan::samples(operand)*2);
+			operand.resize(1);
+		}
+	} else
+	if((mixMode==SPATIAL || mixMode==STEREO) && argMode==VOICE)
+	{
+		projection.stage(mixMode==SPATIAL ? "spatial mix" : "stereo mix",2*longest,samples*6);
+		work=Plan::Shapes(2,mixed);
+	} else
+	if(projection.pipeline>0 || maximizer!=0.0)
+		projection.stage("gains",0,samples*2);
+	projection.pipeline=0;
+
+	if(normalizer)
+		projection.stage("normalize",0,Plan::samples(work)*2);
+
+	Plan::Shapes a(operand);
+	Plan::Shapes b(work);
+	Plan::Shapes merged=Plan::merge(a,b,transitionMode==NONE ? 0 : transitionSeconds,transitionMode==PARALLEL);
+	projection.stage("merge",Plan::bytes(merged),Plan::samples(merged));
+
+	if(intoOperand)
+	{
+		operand=merged;
+		work.clear();
+		projection.next();
+	} else
+		projection.target=merged;
+}
+
 #ifdef CLI
 
 /**
@@ -1369,6 +1660,7 @@ int main(int argc,char * argv[])
 	{
 		LOG(logERROR) << "Out of memory: " << ba.what() << std::endl;
 		LOG(logINFO)  << "Try to increase your physical or virtual memory (swap)" << std::endl;
+		LOG(logINFO)  << "or limit the memory usage with --max-memory" << std::endl;
 		return 3;
 	}
 
@@ -1376,6 +1668,17 @@ int main(int argc,char * argv[])
 
 #endif
 
+bool OspacMain::isOutputOption(const std::string &o)
+{
+	static const char * outputOptions[]={"output","mp3","ogg","flac","opus","aac",
+										 "title","artist","album","comment","category",
+										 "episode","year","image","quality","bits","bitrate"};
+	for(unsigned i=0;i<sizeof(outputOptions)/sizeof(outputOptions[0]);i++)
+		if(o==outputOptions[i])
+			return true;
+	return false;
+}
+
 bool OspacMain::isOption(std::string &o)
 {
 	std::string result(o);
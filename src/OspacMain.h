@@ -15,6 +15,8 @@
 
 #include "Channel.h"
 #include "Encode.h"
+#include "Wave.h"
+#include "Plan.h"
 #include "SelectiveLeveler.h"
 
 /**
@@ -44,6 +46,14 @@ protected:
 	 */
 	bool isOption(std::string &s);
 
+	/**
+	 * Tests if an option adds an output or only sets up following outputs,
+	 * so the queued outputs can still be written together
+	 * @param s option without dashes
+	 * @return true for output options
+	 */
+	bool isOutputOption(const std::string &s);
+
 	/**
 	 * Downmix mode for voice channels.
 	 */
@@ -259,6 +269,11 @@ protected:
 	 */
 	Encode::QualitySetting     quality;
 
+	/**
+	 * Sample format of wave output
+	 */
+	Wave::SampleFormat         waveFormat;
+
 	/**
 	 * Set all variables to their standard setting dependent on data mode
 	 */
@@ -273,6 +288,24 @@ protected:
 	 */
 	void render(Channels & work,Channels & operand,Channels & target);
 
+	/**
+	 * Project the rendering of the current segment like render() on the
+	 * shapes of the projection instead of the samples
+	 * @param intoOperand true if the segment is rendered into the operand,
+	 *                    false if it is rendered into the target
+	 */
+	void renderPlan(bool intoOperand);
+
+	/**
+	 * Only project memory usage and cost instead of processing samples
+	 */
+	bool	planning;
+
+	/**
+	 * Projection of memory usage and cost
+	 */
+	Plan	projection;
+
 	/**
 	 * Standard maximizer factor
 	 */
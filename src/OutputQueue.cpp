@@ -0,0 +1,71 @@
+/**
+ * @file		OutputQueue.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Concurrent writing of the outputs of a production
+ */
+
+#include <exception>
+#include <thread>
+
+#include "OutputQueue.h"
+#include "Log.h"
+
+void OutputQueue::add(const std::string & name,const std::function<int(void)> & write)
+{
+	Output output;
+	output.name=name;
+	output.write=write;
+	outputs.push_back(output);
+}
+
+unsigned OutputQueue::write()
+{
+	if(outputs.empty())
+		return 0;
+
+	std::vector<Output> queued;
+	queued.swap(outputs);
+
+	std::vector<int> results(queued.size(),0);
+	std::vector<std::exception_ptr> errors(queued.size());
+	auto work=[&](unsigned k)
+	{
+		try
+		{
+			results[k]=queued[k].write();
+		}
+		catch(...)
+		{
+			errors[k]=std::current_exception();
+		}
+	};
+
+	// the encoders mostly wait for external processes or the file system,
+	// so each output gets its own thread independent of the cores
+	if(queued.size()>1)
+	{
+		LOG(logDEBUG) << "Writing " << queued.size() << " outputs concurrently" << std::endl;
+		std::vector<std::thread> pool;
+		for(unsigned k=0;k<queued.size();k++)
+			pool.push_back(std::thread(work,k));
+		for(unsigned k=0;k<pool.size();k++)
+			pool[k].join();
+	} else
+		work(0);
+
+	unsigned failed=0;
+	for(unsigned k=0;k<queued.size();k++)
+	{
+		if(errors[k])
+			std::rethrow_exception(errors[k]);
+		if(results[k]!=0)
+		{
+			LOG(logDEBUG) << "Writing " << queued[k].name << " failed with error code " << results[k] << std::endl;
+			failed++;
+		}
+	}
+	return failed;
+}
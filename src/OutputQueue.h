@@ -0,0 +1,62 @@
+/**
+ * @file		OutputQueue.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Concurrent writing of the outputs of a production
+ */
+
+#ifndef OUTPUTQUEUE_H_
+#define OUTPUTQUEUE_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Queue of outputs that are written and encoded concurrently
+ * A production usually ends with several outputs of the same target, e.g.
+ * a wave file, an mp3 and an ogg file. Each output takes a copy of the
+ * target when it is added, which shares the samples with the target (see
+ * BasicChannel), so the outputs only read the rendered samples. The queued
+ * outputs are written by one thread each in write(), so the wall time is
+ * the time of the slowest encoder instead of the sum of all encoders.
+ */
+class OutputQueue
+{
+	/**
+	 * Queued output
+	 */
+	struct Output
+	{
+		std::string					name;
+		std::function<int(void)>	write;
+	};
+
+	std::vector<Output>	outputs;
+
+public:
+	/**
+	 * Queue an output
+	 * @param name  file system name of output
+	 * @param write writes the output on its own copy of the channels and
+	 *              returns 0 in case of success
+	 */
+	void add(const std::string & name,const std::function<int(void)> & write);
+
+	/**
+	 * Check for queued outputs
+	 * @return true if no output is queued
+	 */
+	bool empty() const { return outputs.empty(); }
+
+	/**
+	 * Write all queued outputs concurrently and wait for all of them. The
+	 * queue is empty afterwards.
+	 * @return number of outputs that could not be written
+	 */
+	unsigned write();
+};
+
+#endif /* OUTPUTQUEUE_H_ */
@@ -0,0 +1,201 @@
+/**
+ * @file		Pipeline.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Lazy evaluation of gain, mix and limiter stages
+ */
+
+#include <assert.h>
+
+#include "Pipeline.h"
+#include "Maximizer.h"
+#include "Log.h"
+
+/**
+ * Number of frames processed together in the final sweep
+ */
+static const unsigned blockFrames=256;
+
+Pipeline::Pipeline(Channels & channels) : source(channels), curves(channels.size()),
+		                                  limitFactor(0), limitOrder(4)
+{
+}
+
+bool Pipeline::uniform() const
+{
+	for(unsigned c=1;c<source.size();c++)
+		if(source[c].samplerate()!=source[0].samplerate())
+			return false;
+	return true;
+}
+
+bool Pipeline::pending() const
+{
+	for(unsigned c=0;c<curves.size();c++)
+		if(!curves[c].empty())
+			return true;
+	return false;
+}
+
+Pipeline::View Pipeline::view(unsigned channel) const
+{
+	std::vector<Span<const float> > gains;
+	if(channel<curves.size())
+		for(unsigned k=0;k<curves[channel].size();k++)
+			gains.push_back(curves[channel][k].view());
+	return View(source[channel].view(),gains);
+}
+
+void Pipeline::gain(unsigned channel,const Channel & curve)
+{
+	if(curves.size()<source.size())
+		curves.resize(source.size());
+	curves[channel].push_back(curve);
+}
+
+void Pipeline::limit(float factor,int order)
+{
+	limitFactor=factor;
+	limitOrder=order;
+}
+
+void Pipeline::apply()
+{
+	for(unsigned c=0;c<curves.size() && c<source.size();c++)
+	{
+		if(curves[c].empty())
+			continue;
+		Span<float> s=source[c].span();
+		View v=view(c);
+		for(std::size_t i=0;i<s.size();i++)
+			s[i]=v[i];
+		curves[c].clear();
+	}
+}
+
+void Pipeline::render()
+{
+	// the source must not have been replaced while stages were pending
+	assert(curves.size()==source.size() || !pending());
+
+	if(limitFactor==0)
+	{
+		apply();
+		return;
+	}
+	if(!uniform())
+	{
+		apply();
+		finish(source);
+		return;
+	}
+
+	LOG(logDEBUG) << "Applying gains and limiter in one sweep" << std::endl;
+
+	const unsigned n=source.size();
+	std::vector<Span<float> > s(n);
+	std::vector<View> v;
+	std::size_t length=0;
+	for(unsigned c=0;c<n;c++)
+	{
+		s[c]=source[c].span();
+		v.push_back(view(c));
+		if(s[c].size()>length)
+			length=s[c].size();
+	}
+	std::vector<float> frame(n);
+
+	for(std::size_t start=0;start<length;start+=blockFrames)
+	{
+		std::size_t end=start+blockFrames<length?start+blockFrames:length;
+
+		for(unsigned c=0;c<n;c++)
+			if(c<curves.size() && !curves[c].empty())
+				for(std::size_t i=start;i<end && i<s[c].size();i++)
+					s[c][i]=v[c][i];
+
+		for(std::size_t i=start;i<end;i++)
+		{
+			for(unsigned c=0;c<n;c++)
+				frame[c]=i<s[c].size()?s[c][i]:0;
+			Maximizer::amplifyFrame(&frame[0],n,limitFactor,limitOrder);
+			for(unsigned c=0;c<n;c++)
+				if(i<s[c].size())
+					s[c][i]=frame[c];
+		}
+	}
+
+	for(unsigned c=0;c<curves.size();c++)
+		curves[c].clear();
+	limitFactor=0;
+}
+
+void Pipeline::mix(const MixMatrix & matrix,Channels & target)
+{
+	const unsigned n=source.size();
+	const unsigned rate=n>0?source[0].samplerate():44100;
+
+	LOG(logDEBUG) << "Mixing " << n << " channels into " << matrix.size()
+			      << " channels in one sweep" << std::endl;
+
+	std::vector<View> v;
+	std::size_t length=0;
+	for(unsigned c=0;c<n;c++)
+	{
+		v.push_back(view(c));
+		if(v[c].size()>length)
+			length=v[c].size();
+	}
+
+	if(target.size()<matrix.size())
+		target.resize(matrix.size());
+
+	std::vector<Span<float> > t(matrix.size());
+	std::size_t size=0;
+	for(unsigned o=0;o<matrix.size();o++)
+	{
+		if(target[o].size()==0)
+			target[o]=Channel(rate);
+		if(target[o].size()<length)
+			target[o].resize(length);
+		t[o]=target[o].span();
+		if(t[o].size()>size)
+			size=t[o].size();
+	}
+	std::vector<float> frame(matrix.size());
+
+	for(std::size_t i=0;i<size;i++)
+	{
+		for(unsigned o=0;o<matrix.size();o++)
+			for(unsigned k=0;k<matrix[o].size();k++)
+			{
+				const Tap & tap=matrix[o][k];
+				const View & x=v[tap.input];
+				if(i>=tap.delay && i<x.size())
+					t[o][i]+=tap.weight*x[i-tap.delay];
+			}
+
+		if(limitFactor!=0)
+		{
+			for(unsigned o=0;o<matrix.size();o++)
+				frame[o]=i<t[o].size()?t[o][i]:0;
+			Maximizer::amplifyFrame(&frame[0],matrix.size(),limitFactor,limitOrder);
+			for(unsigned o=0;o<matrix.size();o++)
+				if(i<t[o].size())
+					t[o][i]=frame[o];
+		}
+	}
+
+	for(unsigned c=0;c<curves.size();c++)
+		curves[c].clear();
+	limitFactor=0;
+}
+
+void Pipeline::finish(Channels & output)
+{
+	if(limitFactor!=0)
+		Maximizer::amplify(output,limitFactor,limitOrder);
+	limitFactor=0;
+}
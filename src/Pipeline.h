@@ -0,0 +1,185 @@
+/**
+ * @file		Pipeline.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Lazy evaluation of gain, mix and limiter stages
+ */
+
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <vector>
+
+#include "Channel.h"
+#include "Span.h"
+
+/**
+ * @brief Lazily evaluated chain of gain curves, mixing and limiting
+ *
+ * Several filters only compute a gain for every sample (crosstalk gate,
+ * leveler), the mixers sum up weighted and delayed channels and the
+ * maximizer limits the mixed frames. Applied one after the other, each of
+ * these stages reads and writes all samples again.
+ *
+ * The pipeline keeps the source channels unchanged and collects the gain
+ * curves of each channel instead. Filters that need the current signal
+ * for their analysis read it through a View, which multiplies the gains on
+ * the fly. The final sweep applies all gains, the mix matrix and the
+ * limiter at once, either in place with render() or directly into the mix
+ * target with mix(). The gains are multiplied in the order they were added,
+ * so the results equal the separate passes.
+ *
+ * The pipeline refers to the source channels, so they must not be replaced
+ * while stages are pending. mix() consumes all stages, after which the
+ * caller may replace the source by the mix and must not render() any more.
+ */
+class Pipeline
+{
+	Channels &							source;
+	std::vector<std::vector<Channel> >	curves;
+	float								limitFactor;
+	int									limitOrder;
+public:
+	/**
+	 * @brief Read only view on a channel with all gains of the pipeline
+	 */
+	class View
+	{
+		const float *					samples;
+		std::size_t						length;
+		std::vector<Span<const float> >	gains;
+	public:
+		/**
+		 * Create a view on samples with given gain curves
+		 * @param aSamples samples of the source channel
+		 * @param aGains   gain curves, applied in this order
+		 */
+		View(Span<const float> aSamples,const std::vector<Span<const float> > & aGains)
+			: samples(aSamples.data()), length(aSamples.size()), gains(aGains) {}
+
+		/**
+		 * Unchecked access to a sample with all gains applied. Gain curves
+		 * shorter than the channel do not change the samples beyond.
+		 * @param index of sample (0<=index<size())
+		 * @return sample value
+		 */
+		float operator [](std::size_t index) const
+		{
+			float v=samples[index];
+			for(unsigned k=0;k<gains.size();k++)
+				if(index<gains[k].size())
+					v*=gains[k][index];
+			return v;
+		}
+
+		/**
+		 * Number of samples
+		 * @return number of samples
+		 */
+		std::size_t size() const { return length; }
+	};
+
+	/**
+	 * @brief Contribution of an input channel to an output channel
+	 */
+	struct Tap
+	{
+		unsigned	input;		///< index of input channel
+		float		weight;		///< factor of the input samples
+		unsigned	delay;		///< delay of the input in samples
+
+		Tap(unsigned aInput,float aWeight,unsigned aDelay=0)
+			: input(aInput), weight(aWeight), delay(aDelay) {}
+	};
+
+	/**
+	 * Mix matrix with a list of taps for each output channel
+	 */
+	typedef std::vector<std::vector<Tap> > MixMatrix;
+
+	/**
+	 * Create a pipeline on given channels
+	 * @param channels source channels, changed only by render(), apply() and
+	 *                 filters that need to resample or resize them
+	 */
+	explicit Pipeline(Channels & channels);
+
+	/**
+	 * Source channels without pending gains
+	 * @return source channels
+	 */
+	Channels &  input() { return source; }
+
+	/**
+	 * Number of source channels
+	 * @return number of channels
+	 */
+	unsigned    channels() const { return source.size(); }
+
+	/**
+	 * Check if all source channels have the same sample rate
+	 * @return true if the channels can be mixed directly
+	 */
+	bool        uniform() const;
+
+	/**
+	 * Check if there are gains that were not applied yet
+	 * @return true if views differ from the source channels
+	 */
+	bool        pending() const;
+
+	/**
+	 * View on a channel with all gains added so far
+	 * @param channel index of channel
+	 * @return view with lazily applied gains
+	 */
+	View        view(unsigned channel) const;
+
+	/**
+	 * Add a gain curve to a channel
+	 * @param channel index of channel
+	 * @param curve   factor for each sample of the channel
+	 */
+	void        gain(unsigned channel,const Channel & curve);
+
+	/**
+	 * Limit all output frames by a sigmoid function in the final sweep,
+	 * see Maximizer::amplify()
+	 * @param factor factor
+	 * @param order  order of sigmoid function
+	 */
+	void        limit(float factor,int order=4);
+
+	/**
+	 * Apply all pending gains to the source channels, the limiter stays
+	 * pending. This is needed before filters that change the time line.
+	 */
+	void        apply();
+
+	/**
+	 * Apply all gains and the limiter to the source channels in one sweep
+	 */
+	void        render();
+
+	/**
+	 * Mix the source channels with all gains into the target channels and
+	 * limit the result in one sweep. The source channels are unchanged,
+	 * the gains and the limiter are consumed by the mix.
+	 * The channels must be uniform() and of the sample rate of non-empty
+	 * target channels.
+	 * @param matrix taps for each target channel
+	 * @param target channels to add the mix to, created if necessary
+	 */
+	void        mix(const MixMatrix & matrix,Channels & target);
+
+	/**
+	 * Apply a pending limiter to other channels, for mixers that cannot
+	 * use mix()
+	 * @param output channels to be limited
+	 */
+	void        finish(Channels & output);
+};
+
+#endif /* PIPELINE_H_ */
@@ -0,0 +1,338 @@
+/**
+ * @file		Plan.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Projection of memory usage and processing cost
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <iomanip>
+
+extern "C" {
+	#include <sndfile.h>
+}
+
+#include "Plan.h"
+#include "SampleBuffer.h"
+#include "Log.h"
+
+#ifdef HAS_FFMPEG
+extern "C" {
+	#include <libavformat/avformat.h>
+	#include <libavcodec/avcodec.h>
+}
+#endif
+
+/**
+ * Relative cost per sample of reading uncompressed files
+ */
+static const double pcmCost=1;
+
+/**
+ * Relative cost per sample of decoding compressed files
+ */
+static const double compressedCost=20;
+
+/**
+ * Relative cost per sample of parsing ascii files
+ */
+static const double asciiCost=4;
+
+/**
+ * Restrict the shapes of an input to the loaded time range
+ * @param shapes shapes of the channels of the input
+ * @param first  index of the first channel of the input
+ * @param skip   seconds to skip
+ * @param length maximum seconds to load after skip
+ */
+static void window(Plan::Shapes & shapes,unsigned first,float skip,float length)
+{
+	for(unsigned c=first;c<shapes.size();c++)
+	{
+		double frames=shapes[c].frames-double(skip)*shapes[c].rate;
+		if(frames<0)
+			frames=0;
+		if(frames>double(length)*shapes[c].rate)
+			frames=double(length)*shapes[c].rate;
+		shapes[c].frames=frames;
+	}
+}
+
+/**
+ * Probe the header of a file with libsndfile
+ * @param name   file system name of input
+ * @param target shapes to append the channels to
+ * @return relative cost per sample, negative on errors
+ */
+static double probeSndfile(const std::string & name,Plan::Shapes & target)
+{
+	SF_INFO info;
+	info.format=0;
+	SNDFILE * file=sf_open(name.c_str(),SFM_READ,&info);
+	if(file==NULL)
+		return -1;
+	sf_close(file);
+
+	Plan::Shape shape={unsigned(info.samplerate),double(info.frames)};
+	target.insert(target.end(),info.channels,shape);
+
+	switch(info.format&SF_FORMAT_SUBMASK)
+	{
+	case SF_FORMAT_PCM_16:
+	case SF_FORMAT_PCM_24:
+	case SF_FORMAT_PCM_32:
+	case SF_FORMAT_FLOAT:
+		return pcmCost;
+	default:
+		return compressedCost;
+	}
+}
+
+#ifdef HAS_FFMPEG
+
+/**
+ * Probe all audio streams of a file with libavformat
+ * @param name   file system name of input
+ * @param target shapes to append the channels to
+ * @return relative cost per sample, negative on errors
+ */
+static double probeFfmpeg(const std::string & name,Plan::Shapes & target)
+{
+	av_register_all();
+
+	AVFormatContext * formatContext=NULL;
+	if(avformat_open_input(&formatContext,name.c_str(),NULL,0)!=0)
+		return -1;
+	avformat_find_stream_info(formatContext,NULL);
+
+	unsigned streams=0;
+	for(unsigned i=0;i<formatContext->nb_streams;i++)
+	{
+		AVCodecParameters * parameters=formatContext->streams[i]->codecpar;
+		if(parameters->codec_type!=AVMEDIA_TYPE_AUDIO || parameters->sample_rate<=0)
+			continue;
+		double frames=0;
+		if(formatContext->duration>0)
+			frames=double(formatContext->duration)*parameters->sample_rate/AV_TIME_BASE;
+		Plan::Shape shape={unsigned(parameters->sample_rate),frames};
+		target.insert(target.end(),parameters->channels,shape);
+		streams++;
+	}
+	avformat_close_input(&formatContext);
+	return streams>0 ? compressedCost : -1;
+}
+
+#endif // HAS_FFMPEG
+
+/**
+ * Estimate the shape of an ascii file by counting its lines with values
+ * and the values of the first of these lines
+ * @param name       file system name of input
+ * @param samplerate sample rate of input
+ * @param target     shapes to append the channels to
+ * @return relative cost per sample, negative on errors
+ */
+static double probeAscii(const std::string & name,int samplerate,Plan::Shapes & target)
+{
+	int fd=open(name.c_str(),O_RDONLY);
+	if(fd<0)
+		return -1;
+
+	std::vector<char> buffer(1<<20);
+	double lines=0;
+	unsigned columns=0;
+	unsigned column=0;
+	bool value=false;
+	bool comment=false;
+	for(ssize_t n=read(fd,&buffer[0],buffer.size());n>0;n=read(fd,&buffer[0],buffer.size()))
+	{
+		for(const char * p=&buffer[0];p<&buffer[0]+n;p++)
+		{
+			char c=*p;
+			if(c=='\n' || c=='\r')
+			{
+				if(column>0)
+				{
+					if(columns==0)
+						columns=column;
+					lines++;
+				}
+				column=0;
+				value=false;
+				comment=false;
+			} else
+			if(c=='#' || comment)
+				comment=true;
+			else
+			if(c==' ' || c=='\t')
+				value=false;
+			else
+			if(!value)
+			{
+				value=true;
+				column++;
+			}
+		}
+	}
+	close(fd);
+	if(column>0)
+	{
+		if(columns==0)
+			columns=column;
+		lines++;
+	}
+
+	if(columns==0)
+		return -1;
+	Plan::Shape shape={unsigned(samplerate),lines};
+	target.insert(target.end(),columns,shape);
+	return asciiCost;
+}
+
+double Plan::probe(const std::string & name,Decoder decoder,float skip,float length,
+		           int samplerate,Shapes & target)
+{
+	unsigned first=target.size();
+	double cost;
+	switch(decoder)
+	{
+	#ifdef HAS_FFMPEG
+	case FFMPEG:
+		cost=probeFfmpeg(name,target);
+		break;
+	#endif
+	case ASCII:
+		cost=probeAscii(name,samplerate,target);
+		break;
+	default:
+		cost=probeSndfile(name,target);
+		break;
+	}
+	if(cost<0)
+		return cost;
+
+	window(target,first,skip,length);
+
+	double frames=0;
+	for(unsigned c=first;c<target.size();c++)
+		frames+=target[c].frames;
+	return cost*frames;
+}
+
+void Plan::stage(const std::string & name,double extra,double cost)
+{
+	Stage s;
+	s.segment=segment;
+	s.name=name;
+	s.peak=resident()+extra;
+	s.cost=cost;
+	stages.push_back(s);
+
+	LOG(logDEBUG) << "Plan " << name << ": " << s.peak/1048576 << "MB, cost " << cost << std::endl;
+}
+
+Plan::Shapes Plan::merge(Shapes & a,Shapes & b,float seconds,bool parallel)
+{
+	Shape silent={1,0};
+	while(b.size()<a.size())
+		b.push_back(silent);
+	while(a.size()<b.size())
+		a.push_back(silent);
+
+	unsigned rate=1;
+	for(unsigned c=0;c<a.size();c++)
+		rate=std::max(rate,std::max(a[c].rate,b[c].rate));
+	for(unsigned c=0;c<a.size();c++)
+	{
+		a[c].frames=a[c].frames*rate/a[c].rate;
+		a[c].rate=rate;
+		b[c].frames=b[c].frames*rate/b[c].rate;
+		b[c].rate=rate;
+	}
+	if(a.empty() || parallel)
+		return a;
+
+	double overlap=double(seconds)*rate;
+	if(overlap>a[0].frames+b[0].frames)
+		overlap=a[0].frames+b[0].frames;
+
+	Shapes target(a);
+	for(unsigned c=0;c<a.size();c++)
+		target[c].frames=a[c].frames+b[c].frames-overlap;
+	return target;
+}
+
+double Plan::bytes(const Shapes & shapes)
+{
+	return samples(shapes)*sizeof(float);
+}
+
+double Plan::largest(const Shapes & shapes)
+{
+	double frames=0;
+	for(unsigned c=0;c<shapes.size();c++)
+		frames=std::max(frames,shapes[c].frames);
+	return frames*sizeof(float);
+}
+
+double Plan::samples(const Shapes & shapes)
+{
+	double samples=0;
+	for(unsigned c=0;c<shapes.size();c++)
+		samples+=shapes[c].frames;
+	return samples;
+}
+
+double Plan::resident() const
+{
+	return bytes(work)+bytes(operand)+bytes(target)+pipeline;
+}
+
+double Plan::peak() const
+{
+	double peak=resident();
+	for(unsigned i=0;i<stages.size();i++)
+		peak=std::max(peak,stages[i].peak);
+	return peak;
+}
+
+void Plan::print(std::ostream & out) const
+{
+	double total=0;
+	for(unsigned i=0;i<stages.size();i++)
+		total+=stages[i].cost;
+	if(total<=0)
+		total=1;
+
+	out << std::endl;
+	out << " Segment  Stage                              Peak MB    Cost %" << std::endl;
+	out << std::fixed << std::setprecision(1);
+	for(unsigned i=0;i<stages.size();i++)
+	{
+		std::string name=stages[i].name;
+		if(name.size()>32)
+			name="..."+name.substr(name.size()-29);
+		out << std::setw(8) << stages[i].segment << "  "
+		    << std::left << std::setw(32) << name << std::right
+		    << std::setw(11) << stages[i].peak/1048576
+		    << std::setw(10) << 100*stages[i].cost/total << std::endl;
+	}
+	out << std::endl;
+	out << "Projected peak sample memory: " << peak()/1048576 << " MB" << std::endl;
+	if(SampleBuffer::memoryLimit()>0 && peak()>SampleBuffer::memoryLimit())
+		out << "  at most " << SampleBuffer::memoryLimit()/1048576
+		    << " MB in memory, the rest in temporary files" << std::endl;
+
+	const Shapes & result=target.empty() ? operand : target;
+	if(!result.empty() && result[0].rate>0)
+	{
+		unsigned seconds=result[0].frames/result[0].rate;
+		out << "Projected output: " << result.size() << " channels of "
+		    << seconds/60 << ":" << std::setw(2) << std::setfill('0') << seconds%60
+		    << std::setfill(' ') << " minutes" << std::endl;
+	}
+	out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file		Plan.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Projection of memory usage and processing cost
+ */
+
+#ifndef PLAN_H_
+#define PLAN_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+/**
+ * @brief Projected memory usage and cost of a production without decoding
+ * or processing any samples
+ *
+ * The inputs are only probed for their sample rate, channel count and
+ * duration from their headers. The render stages then only track the
+ * shapes of the channels of the current segment, the rendered segments
+ * and the rendered target, and record for each stage the projected peak
+ * of the sample memory and its cost relative to the other stages.
+ *
+ * The projection is an estimate: Skipped silence is not known in advance,
+ * so the filters are assumed to keep the length, and the costs are
+ * weights per sample derived from the operations of the filters.
+ */
+class Plan
+{
+public:
+	/**
+	 * Shape of a channel
+	 */
+	struct Shape
+	{
+		unsigned	rate;	//!< sample rate
+		double		frames;	//!< number of samples
+	};
+
+	/**
+	 * Shapes of the channels of a segment
+	 */
+	typedef std::vector<Shape> Shapes;
+
+	/**
+	 * Decoder of an input
+	 */
+	enum Decoder {
+		SNDFILE,	//!< wave files, read by libsndfile or from a mapping
+		FFMPEG,		//!< compressed files, decoded by libavcodec
+		ASCII		//!< ascii files
+	};
+
+	Shapes	work;		//!< channels of the current segment
+	Shapes	operand;	//!< channels of all rendered segments
+	Shapes	target;		//!< channels of the rendered target
+	double	pipeline;	//!< bytes of gain curves of the current segment
+
+private:
+	/**
+	 * Projection of a stage
+	 */
+	struct Stage
+	{
+		unsigned	segment;
+		std::string	name;
+		double		peak;
+		double		cost;
+	};
+
+	std::vector<Stage>	stages;
+	unsigned			segment;
+
+public:
+	Plan() : pipeline(0), segment(1) {}
+
+	/**
+	 * Probe the header of an input and append the shapes of its channels
+	 * @param name       file system name of input
+	 * @param decoder    decoder that loads the input
+	 * @param skip       seconds to skip
+	 * @param length     maximum seconds to load after skip
+	 * @param samplerate sample rate of ascii inputs
+	 * @param target     shapes to append the channels to
+	 * @return relative cost of decoding, negative if the input could not
+	 *         be probed
+	 */
+	static double probe(const std::string & name,Decoder decoder,float skip,float length,
+			            int samplerate,Shapes & target);
+
+	/**
+	 * Record a stage working on the current shapes
+	 * @param name  name of stage
+	 * @param extra bytes used by the stage in addition to all channels
+	 * @param cost  relative cost of the stage
+	 */
+	void stage(const std::string & name,double extra,double cost);
+
+	/**
+	 * Continue with the next segment
+	 */
+	void next() { segment++; }
+
+	/**
+	 * Shapes of merged segments, see Merge
+	 * @param a        first segment, padded and resampled like in Merge
+	 * @param b        second segment, padded and resampled like in Merge
+	 * @param seconds  overlap of the segments in seconds
+	 * @param parallel true if the segments are mixed in parallel
+	 * @return shapes of the merged segments
+	 */
+	static Shapes merge(Shapes & a,Shapes & b,float seconds,bool parallel);
+
+	/**
+	 * Bytes of all channels of a segment
+	 * @param shapes channels of segment
+	 * @return number of bytes
+	 */
+	static double bytes(const Shapes & shapes);
+
+	/**
+	 * Bytes of the longest channel of a segment
+	 * @param shapes channels of segment
+	 * @return number of bytes
+	 */
+	static double largest(const Shapes & shapes);
+
+	/**
+	 * Samples of all channels of a segment
+	 * @param shapes channels of segment
+	 * @return number of samples
+	 */
+	static double samples(const Shapes & shapes);
+
+	/**
+	 * Bytes of all tracked channels and gain curves
+	 * @return number of bytes
+	 */
+	double resident() const;
+
+	/**
+	 * Projected peak of sample memory of all stages
+	 * @return number of bytes
+	 */
+	double peak() const;
+
+	/**
+	 * Print the projection of all stages
+	 * @param out stream to print to
+	 */
+	void print(std::ostream & out) const;
+};
+
+#endif /* PLAN_H_ */
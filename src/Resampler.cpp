@@ -0,0 +1,269 @@
+/**
+ * @file		Resampler.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Windowed-sinc polyphase sample rate conversion
+ */
+
+#include <math.h>
+
+#include "Resampler.h"
+#include "Log.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RESAMPLER_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Maximum number of precomputed filter phases
+ */
+static const unsigned maxPhases=1024;
+
+/**
+ * Maximum number of filter taps on either side when downsampling
+ */
+static const unsigned maxHalfTaps=1024;
+
+/**
+ * Number of consumed input samples to collect before the history is shortened
+ */
+static const unsigned compactThreshold=16384;
+
+typedef float (*DotKernel)(const float *,const float *,unsigned);
+
+/**
+ * Dot product of filter and input, n is a multiple of 8
+ */
+static float dotScalar(const float * a,const float * b,unsigned n)
+{
+	float sum=0;
+	for(unsigned i=0;i<n;i++)
+		sum+=a[i]*b[i];
+	return sum;
+}
+
+#ifdef RESAMPLER_X86
+
+__attribute__((target("sse2")))
+static float dotSse2(const float * a,const float * b,unsigned n)
+{
+	__m128 s0=_mm_setzero_ps(),s1=_mm_setzero_ps();
+	for(unsigned i=0;i<n;i+=8)
+	{
+		s0=_mm_add_ps(s0,_mm_mul_ps(_mm_loadu_ps(a+i),_mm_loadu_ps(b+i)));
+		s1=_mm_add_ps(s1,_mm_mul_ps(_mm_loadu_ps(a+i+4),_mm_loadu_ps(b+i+4)));
+	}
+	float s[4];
+	_mm_storeu_ps(s,_mm_add_ps(s0,s1));
+	return (s[0]+s[1])+(s[2]+s[3]);
+}
+
+__attribute__((target("avx")))
+static float dotAvx(const float * a,const float * b,unsigned n)
+{
+	__m256 s0=_mm256_setzero_ps();
+	for(unsigned i=0;i<n;i+=8)
+		s0=_mm256_add_ps(s0,_mm256_mul_ps(_mm256_loadu_ps(a+i),_mm256_loadu_ps(b+i)));
+	__m128 s=_mm_add_ps(_mm256_castps256_ps128(s0),_mm256_extractf128_ps(s0,1));
+	float r[4];
+	_mm_storeu_ps(r,s);
+	return (r[0]+r[1])+(r[2]+r[3]);
+}
+
+#endif
+
+/**
+ * Dot product kernel for the processor in use, selected on first use
+ */
+struct ResamplerKernel
+{
+	DotKernel    dot;
+	const char * name;
+
+	ResamplerKernel() : dot(dotScalar), name("scalar")
+	{
+#ifdef RESAMPLER_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx"))
+		{
+			dot=dotAvx;
+			name="avx";
+		} else
+		if(__builtin_cpu_supports("sse2"))
+		{
+			dot=dotSse2;
+			name="sse2";
+		}
+#endif
+		LOG(logDEBUG) << "Using " << name << " resampler kernel" << std::endl;
+	}
+};
+
+static DotKernel dotKernel()
+{
+	static ResamplerKernel k;
+	return k.dot;
+}
+
+/**
+ * Greatest common divisor
+ */
+static unsigned gcd(unsigned a,unsigned b)
+{
+	while(b!=0)
+	{
+		unsigned t=a%b;
+		a=b;
+		b=t;
+	}
+	return a;
+}
+
+/**
+ * Modified Bessel function of the first kind of order zero
+ */
+static double besselI0(double x)
+{
+	double sum=1,term=1;
+	for(unsigned k=1;k<50;k++)
+	{
+		term*=(x/(2*k))*(x/(2*k));
+		sum+=term;
+		if(term<sum*1e-12)
+			break;
+	}
+	return sum;
+}
+
+Resampler::Resampler(unsigned inRate,unsigned outRate,unsigned halfTaps)
+{
+	if(inRate==0 || outRate==0)
+		inRate=outRate=1;
+
+	unsigned g=gcd(inRate,outRate);
+	up=outRate/g;
+	down=inRate/g;
+
+	double ratio=double(up)/down;
+	double cutoff=0.5*0.91;
+	const double beta=8.0;
+
+	if(halfTaps<1)
+		halfTaps=1;
+	half=halfTaps;
+	if(ratio<1)
+	{
+		cutoff*=ratio;
+		half=unsigned(ceil(halfTaps/ratio));
+		if(half>maxHalfTaps)
+			half=maxHalfTaps;
+	}
+	taps=((2*half+7)/8)*8;
+
+	phases=up<maxPhases?up:maxPhases;
+
+	table.assign(phases*taps,0);
+	for(unsigned q=0;q<phases;q++)
+	{
+		double frac=double(q)/phases;
+		double sum=0;
+		for(unsigned j=0;j<2*half;j++)
+			sum+=kernel(double(j)-(half-1)-frac,cutoff,beta);
+		for(unsigned j=0;j<2*half;j++)
+			table[q*taps+j]=kernel(double(j)-(half-1)-frac,cutoff,beta)/sum;
+	}
+
+	LOG(logDEBUG) << "Resampler " << inRate << "Hz to " << outRate << "Hz: "
+			      << up << "/" << down << " with " << phases << " phases of "
+			      << taps << " taps" << std::endl;
+
+	reset();
+}
+
+double Resampler::kernel(double x,double cutoff,double beta) const
+{
+	double r=x/half;
+	if(r<-1 || r>1)
+		return 0;
+
+	double sinc;
+	if(fabs(x)<1e-9)
+		sinc=2*cutoff;
+	else
+		sinc=sin(2*M_PI*cutoff*x)/(M_PI*x);
+
+	return sinc*besselI0(beta*sqrt(1-r*r))/besselI0(beta);
+}
+
+void Resampler::reset()
+{
+	// the history starts with half-1 zeros, so the filter window of the
+	// first output samples starts at history index 0
+	history.assign(half-1,0);
+	historyStart=0;
+	consumed=0;
+	produced=0;
+	finished=false;
+}
+
+uint64_t Resampler::outputLength(uint64_t inputLength) const
+{
+	return inputLength*up/down;
+}
+
+unsigned Resampler::process(const float * in,unsigned count,float * out,unsigned capacity)
+{
+	history.insert(history.end(),in,in+count);
+	consumed+=count;
+	return produce(out,capacity,outputLength(consumed));
+}
+
+unsigned Resampler::finish(float * out,unsigned capacity)
+{
+	if(!finished)
+	{
+		history.insert(history.end(),taps-half,0);
+		finished=true;
+	}
+	return produce(out,capacity,outputLength(consumed));
+}
+
+unsigned Resampler::produce(float * out,unsigned capacity,uint64_t limit)
+{
+	DotKernel dot=dotKernel();
+	uint64_t  available=historyStart+history.size();
+	unsigned  count=0;
+
+	while(count<capacity && produced<limit)
+	{
+		uint64_t pos=produced*down;
+		uint64_t first=pos/up;
+		uint64_t phase=pos%up;
+
+		if(phases<up)
+		{
+			phase=(phase*phases+up/2)/up;
+			if(phase==phases)
+			{
+				phase=0;
+				first++;
+			}
+		}
+		if(first+taps>available)
+			break;
+
+		out[count++]=dot(&table[phase*taps],&history[first-historyStart],taps);
+		produced++;
+	}
+
+	uint64_t next=(produced*down)/up;
+	if(next>historyStart+compactThreshold)
+	{
+		history.erase(history.begin(),history.begin()+(next-historyStart));
+		historyStart=next;
+	}
+	return count;
+}
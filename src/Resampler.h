@@ -0,0 +1,110 @@
+/**
+ * @file		Resampler.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Windowed-sinc polyphase sample rate conversion
+ */
+
+#ifndef RESAMPLER_H_
+#define RESAMPLER_H_
+
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @brief Streaming windowed-sinc polyphase resampler
+ *
+ * The ratio of the sample rates is reduced to up/down. Each output sample
+ * lies between two input samples at a fractional position, one of up
+ * possible phases. The Kaiser windowed sinc filter is precomputed for
+ * every phase, so an output sample is a single dot product of the filter
+ * table with the input (done with SSE2 or AVX if available). For very
+ * unusual ratios the number of phases is limited and the nearest phase
+ * is used.
+ *
+ * The cutoff is placed below the lower of both Nyquist frequencies, so
+ * downsampling is band limited as well.
+ *
+ * The input is fed in blocks by process() and the remaining output is
+ * fetched by finish(). For an input of n samples, the output has exactly
+ * outputLength(n) samples, aligned to the same start time.
+ */
+class Resampler
+{
+	unsigned			up;
+	unsigned			down;
+	unsigned			phases;
+	unsigned			half;
+	unsigned			taps;
+	std::vector<float>	table;
+
+	std::vector<float>	history;
+	uint64_t			historyStart;
+	uint64_t			consumed;
+	uint64_t			produced;
+	bool				finished;
+
+public:
+	/**
+	 * Create a resampler between the given sample rates
+	 * @param inRate   sample rate of input in Hertz
+	 * @param outRate  sample rate of output in Hertz
+	 * @param halfTaps number of filter taps on either side of an output sample
+	 */
+	Resampler(unsigned inRate,unsigned outRate,unsigned halfTaps=32);
+
+	/**
+	 * Feed the next block of input samples and fetch the output samples
+	 * that are complete. Output that does not fit into the given capacity
+	 * is kept for the next call.
+	 * @param in       input samples
+	 * @param count    number of input samples
+	 * @param out      buffer for output samples
+	 * @param capacity maximum number of output samples to write
+	 * @return number of output samples written
+	 */
+	unsigned process(const float * in,unsigned count,float * out,unsigned capacity);
+
+	/**
+	 * Fetch the remaining output samples after the last input block
+	 * @param out      buffer for output samples
+	 * @param capacity maximum number of output samples to write
+	 * @return number of output samples written
+	 */
+	unsigned finish(float * out,unsigned capacity);
+
+	/**
+	 * Number of output samples for given number of input samples
+	 * @param inputLength number of input samples
+	 * @return number of output samples
+	 */
+	uint64_t outputLength(uint64_t inputLength) const;
+
+	/**
+	 * Start over with a new stream with the same rates
+	 */
+	void     reset();
+
+private:
+	/**
+	 * Produce output samples as far as the available input allows
+	 * @param out      buffer for output samples
+	 * @param capacity maximum number of output samples to write
+	 * @param limit    total number of output samples of the stream
+	 * @return number of output samples written
+	 */
+	unsigned produce(float * out,unsigned capacity,uint64_t limit);
+
+	/**
+	 * Kaiser windowed sinc filter
+	 * @param x      distance from center in input samples
+	 * @param cutoff cutoff frequency relative to input sample rate
+	 * @param beta   Kaiser window parameter
+	 * @return filter value
+	 */
+	double   kernel(double x,double cutoff,double beta) const;
+};
+
+#endif /* RESAMPLER_H_ */
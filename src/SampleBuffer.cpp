@@ -0,0 +1,251 @@
+/**
+ * @file		SampleBuffer.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Sample storage in memory or in memory mapped temporary files
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <vector>
+#include <new>
+#include <algorithm>
+
+#include "SampleBuffer.h"
+#include "BufferPool.h"
+#include "Log.h"
+
+std::size_t              SampleBuffer::limit=0;
+std::atomic<std::size_t> SampleBuffer::heapBytes(0);
+std::atomic<std::size_t> SampleBuffer::mappedBytes(0);
+
+SampleBuffer::SampleBuffer(std::size_t size) : samples(0), length(0), capacity(0), isMapped(false), isFile(false), mapOffset(0)
+{
+	allocate(size);
+}
+
+SampleBuffer::SampleBuffer(const void * source,std::size_t size) : samples(0), length(0), capacity(0), isMapped(false), isFile(false), mapOffset(0)
+{
+	allocate(size);
+	if(size>0)
+		memcpy(samples,source,size);
+}
+
+SampleBuffer::SampleBuffer(const SampleBuffer & other) : samples(0), length(0), capacity(0), isMapped(false), isFile(false), mapOffset(0)
+{
+	allocate(other.length);
+	if(length>0)
+		memcpy(samples,other.samples,length);
+}
+
+SampleBuffer::SampleBuffer(int fd,std::size_t offset,std::size_t size)
+	: samples(0), length(0), capacity(0), isMapped(false), isFile(false), mapOffset(0)
+{
+	if(size==0)
+		return;
+
+	// mappings start at page boundaries
+	std::size_t page=sysconf(_SC_PAGESIZE);
+	std::size_t start=offset-offset%page;
+
+	void * p=mmap(0,size+offset-start,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,start);
+	if(p==MAP_FAILED)
+	{
+		LOG(logWARNING) << "Could not map " << size << " bytes of input file, reading it" << std::endl;
+		allocate(size);
+		char * target=(char*)samples;
+		std::size_t left=size;
+		while(left>0)
+		{
+			ssize_t n=pread(fd,target,left,offset);
+			if(n<0 && errno==EINTR)
+				continue;
+			if(n<=0)
+			{
+				// an empty buffer tells the caller that the range is not available
+				LOG(logERROR) << "Could not read " << size << " bytes of input file" << std::endl;
+				length=0;
+				return;
+			}
+			target+=n;
+			left-=n;
+			offset+=n;
+		}
+		return;
+	}
+
+#ifdef MADV_SEQUENTIAL
+	madvise(p,size+offset-start,MADV_SEQUENTIAL);
+#endif
+
+	samples=(char*)p+(offset-start);
+	length=size;
+	capacity=size;
+	isMapped=true;
+	isFile=true;
+	mapOffset=offset-start;
+}
+
+SampleBuffer::~SampleBuffer()
+{
+	if(isMapped)
+	{
+		munmap((char*)samples-mapOffset,capacity+mapOffset);
+		if(!isFile)
+			mappedBytes-=capacity;
+	} else
+	{
+		if(!BufferPool::release(samples,capacity))
+			free(samples);
+		heapBytes-=capacity;
+	}
+}
+
+void SampleBuffer::resize(std::size_t size)
+{
+	if(size>capacity)
+		reserve(size);
+	if(size>length)
+		memset((char*)samples+length,0,size-length);
+	length=size;
+}
+
+void SampleBuffer::reserve(std::size_t size)
+{
+	if(size<=capacity)
+		return;
+
+	if(samples!=0 && !isMapped && (limit==0 || heapBytes+size-capacity<=limit))
+	{
+		void * p=realloc(samples,size);
+		if(p==NULL)
+			throw std::bad_alloc();
+		heapBytes+=size-capacity;
+		samples=p;
+		capacity=size;
+		return;
+	}
+
+	// move to new storage, which may be mapped to a temporary file
+	SampleBuffer other(size);
+	if(length>0)
+		memcpy(other.samples,samples,length);
+	std::swap(samples,other.samples);
+	std::swap(capacity,other.capacity);
+	std::swap(isMapped,other.isMapped);
+	std::swap(isFile,other.isFile);
+	std::swap(mapOffset,other.mapOffset);
+}
+
+void SampleBuffer::allocate(std::size_t size)
+{
+	if(size==0)
+		return;
+
+	std::size_t reserved;
+	void * p=BufferPool::acquire(size,reserved);
+	if(p!=NULL)
+	{
+		memset(p,0,size);
+		samples=p;
+		length=size;
+		capacity=reserved;
+		heapBytes+=reserved;
+		return;
+	}
+
+	if(limit>0 && heapBytes+BufferPool::idleUsage()+size>limit)
+		BufferPool::trim();
+
+	if(limit>0 && heapBytes+size>limit && map(size))
+		return;
+
+	samples=calloc(size,1);
+	if(samples==NULL)
+		throw std::bad_alloc();
+	length=size;
+	capacity=size;
+	heapBytes+=size;
+}
+
+bool SampleBuffer::map(std::size_t bytes)
+{
+	std::string pattern=tempDirectory()+"/ospac-XXXXXX";
+	std::vector<char> name(pattern.begin(),pattern.end());
+	name.push_back(0);
+
+	int fd=mkstemp(&name[0]);
+	if(fd<0)
+	{
+		LOG(logWARNING) << "Could not create temporary file " << pattern
+				        << ", keeping samples in memory" << std::endl;
+		return false;
+	}
+	unlink(&name[0]);
+
+	if(ftruncate(fd,bytes)!=0)
+	{
+		LOG(logWARNING) << "Could not extend temporary file to " << bytes
+				        << " bytes, keeping samples in memory" << std::endl;
+		close(fd);
+		return false;
+	}
+
+	void * p=mmap(0,bytes,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+
+	if(p==MAP_FAILED)
+	{
+		LOG(logWARNING) << "Could not map temporary file of " << bytes
+				        << " bytes, keeping samples in memory" << std::endl;
+		return false;
+	}
+
+#ifdef MADV_SEQUENTIAL
+	madvise(p,bytes,MADV_SEQUENTIAL);
+#endif
+
+	samples=p;
+	length=bytes;
+	capacity=bytes;
+	isMapped=true;
+	mappedBytes+=bytes;
+
+	LOG(logDEBUG) << "Mapped " << bytes << " bytes to temporary file, "
+			      << heapBytes << " bytes on heap, "
+			      << mappedBytes << " bytes mapped" << std::endl;
+	return true;
+}
+
+std::string SampleBuffer::tempDirectory()
+{
+	const char * dir=getenv("TMPDIR");
+	if(dir!=NULL && dir[0]!=0)
+		return dir;
+	return "/tmp";
+}
+
+void SampleBuffer::setMemoryLimit(std::size_t bytes)
+{
+	limit=bytes;
+}
+
+std::size_t SampleBuffer::memoryLimit()
+{
+	return limit;
+}
+
+std::size_t SampleBuffer::heapUsage()
+{
+	return heapBytes;
+}
+
+std::size_t SampleBuffer::mappedUsage()
+{
+	return mappedBytes;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file		SampleBuffer.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Sample storage in memory or in memory mapped temporary files
+ */
+
+#ifndef SAMPLEBUFFER_H_
+#define SAMPLEBUFFER_H_
+
+#include <cstddef>
+#include <atomic>
+#include <string>
+
+/**
+ * @brief Fixed size storage of sample data
+ *
+ * The buffer does not know about the sample type, it is used by channels
+ * of all sample types (see BasicChannel).
+ *
+ * Sample buffers are allocated on the heap as long as the total heap
+ * usage of all buffers stays below the memory limit set by
+ * setMemoryLimit(). Larger allocations are spilled to a memory mapped
+ * and already unlinked temporary file, so the operating system only keeps
+ * the segments in memory that are currently worked on. Since the filters
+ * mostly work sequentially on the samples, mapped buffers are advised for
+ * sequential access.
+ *
+ * Heap storage is recycled by an active BufferPool, so the storage of a
+ * buffer may be slightly larger than its size.
+ *
+ * New buffers are always initialized to zero. Buffers may also present a
+ * range of an input file without reading it (see MappedWave): The file is
+ * mapped copy-on-write, so its pages are only read on access and modified
+ * pages become private to the buffer.
+ */
+class SampleBuffer
+{
+	void *			samples;
+	std::size_t		length;
+	std::size_t		capacity;
+	bool			isMapped;
+	bool			isFile;
+	std::size_t		mapOffset;
+
+	static std::size_t				limit;
+	static std::atomic<std::size_t>	heapBytes;
+	static std::atomic<std::size_t>	mappedBytes;
+public:
+	/**
+	 * Create a buffer with given number of zero bytes
+	 * @param size number of bytes
+	 */
+	explicit SampleBuffer(std::size_t size=0);
+
+	/**
+	 * Create a buffer with a copy of given data
+	 * @param source data to be copied
+	 * @param size   number of bytes
+	 */
+	SampleBuffer(const void * source,std::size_t size);
+
+	/**
+	 * Create a buffer presenting a range of a file without copying it. The
+	 * data is aligned to the offset within the file only. If the range can
+	 * neither be mapped nor read, the buffer is empty.
+	 * @param fd     descriptor of the file opened for reading
+	 * @param offset offset of the range in bytes
+	 * @param size   number of bytes
+	 */
+	SampleBuffer(int fd,std::size_t offset,std::size_t size);
+
+	/**
+	 * Create a copy of a buffer, the copy may use a different storage
+	 * @param other buffer to be copied
+	 */
+	SampleBuffer(const SampleBuffer & other);
+
+	virtual ~SampleBuffer();
+
+	/**
+	 * Pointer to the data, aligned for all sample types
+	 * @return pointer to sample data
+	 */
+	void *        data() { return samples; }
+
+	/**
+	 * Pointer to the data for read only access
+	 * @return pointer to sample data
+	 */
+	const void *  data() const { return samples; }
+
+	/**
+	 * Size of this buffer
+	 * @return number of bytes
+	 */
+	std::size_t   size() const { return length; }
+
+	/**
+	 * Size of the storage of this buffer, at least size()
+	 * @return number of bytes that fit without reallocation
+	 */
+	std::size_t   reserved() const { return capacity; }
+
+	/**
+	 * Change the size of this buffer, keeping the data. New bytes are zero,
+	 * shrinking keeps the storage for later growth.
+	 * @param size new number of bytes
+	 */
+	void          resize(std::size_t size);
+
+	/**
+	 * Enlarge the storage of this buffer without changing its size
+	 * @param size number of bytes that shall fit without reallocation
+	 */
+	void          reserve(std::size_t size);
+
+	/**
+	 * Check if the samples are stored in a memory mapped temporary file
+	 * @return true if the buffer was spilled to disc
+	 */
+	bool          mapped() const { return isMapped && !isFile; }
+
+	/**
+	 * Check if the samples are a mapped range of an input file
+	 * @return true if the buffer presents a file
+	 */
+	bool          file() const { return isFile; }
+
+	/**
+	 * Set the maximum number of bytes all heap allocated sample buffers
+	 * may use before new buffers are spilled to temporary files
+	 * @param bytes memory limit in bytes, 0 for no limit
+	 */
+	static void        setMemoryLimit(std::size_t bytes);
+
+	/**
+	 * Current memory limit
+	 * @return memory limit in bytes, 0 if there is no limit
+	 */
+	static std::size_t memoryLimit();
+
+	/**
+	 * Number of bytes currently allocated on the heap by all buffers
+	 * @return heap usage in bytes
+	 */
+	static std::size_t heapUsage();
+
+	/**
+	 * Number of bytes currently mapped to temporary files by all buffers
+	 * @return mapped size in bytes
+	 */
+	static std::size_t mappedUsage();
+
+private:
+	SampleBuffer & operator =(const SampleBuffer &);
+
+	/**
+	 * Allocate storage of the given size, either on the heap or in a
+	 * temporary file depending on the memory limit
+	 * @param size number of bytes
+	 */
+	void allocate(std::size_t size);
+
+	/**
+	 * Try to map zero initialized storage in an unlinked temporary file
+	 * @param size number of bytes
+	 * @return true on success
+	 */
+	bool map(std::size_t size);
+
+	/**
+	 * Directory for temporary files, $TMPDIR or /tmp
+	 * @return directory name
+	 */
+	static std::string tempDirectory();
+};
+
+#endif /* SAMPLEBUFFER_H_ */
@@ -15,54 +15,111 @@
 #include "Wave.h"
 
 
+
 void SelectiveLeveler::level(Channels &aChannels,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
 {
-	for(unsigned i=0;i<aChannels.size();i++)
-	{
-		LOG(logINFO) << "Working on channel " << i << std::endl;
-		level(aChannels[i],targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
-	}
+	level(aChannels,SINGLE,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
 }
 
 void SelectiveLeveler::levelStereo(Channels &aChannels,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
 {
-	LOG(logINFO) << "Here!" << std::endl;
-	for(unsigned i=0;i<aChannels.size();i+=2)
+	level(aChannels,STEREO,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+}
+
+void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+{
+	Channels channels(1);
+	channels[0]=std::move(c);
+	Pipeline p(channels);
+	levelSingle(p,0,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+	p.apply();
+	c=std::move(channels[0]);
+}
+
+void SelectiveLeveler::levelStereo(Channel &a,Channel &b,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+{
+	Channels channels(2);
+	channels[0]=std::move(a);
+	channels[1]=std::move(b);
+	Pipeline p(channels);
+	levelPair(p,0,1,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+	p.apply();
+	a=std::move(channels[0]);
+	b=std::move(channels[1]);
+}
+
+void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+{
+	Pipeline p(c);
+	level(p,mode,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+	p.apply();
+}
+
+void SelectiveLeveler::level(Pipeline &p,ChannelMode mode,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+{
+	switch(mode)
 	{
-		if(i+1<aChannels.size())
-		{
-			LOG(logINFO) << "Working on channels " << i << " and " << i+1 << std::endl;
-			levelStereo(aChannels[i],aChannels[i+1],targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
-		} else
+	case SINGLE:
+		for(unsigned i=0;i<p.channels();i++)
 		{
 			LOG(logINFO) << "Working on channel " << i << std::endl;
-			level(aChannels[i],targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+			levelSingle(p,i,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
 		}
+		return;
+	case STEREO:
+		LOG(logINFO) << "Here!" << std::endl;
+		for(unsigned i=0;i<p.channels();i+=2)
+		{
+			if(i+1<p.channels())
+			{
+				LOG(logINFO) << "Working on channels " << i << " and " << i+1 << std::endl;
+				levelPair(p,i,i+1,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+			} else
+			{
+				LOG(logINFO) << "Working on channel " << i << std::endl;
+				levelSingle(p,i,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+			}
+		}
+		return;
+	case MULTI:
+		levelMulti(p,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
+		return;
 	}
 }
 
-void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+void SelectiveLeveler::levelSingle(Pipeline &p,unsigned channel,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
 {
 	float maxL2=0;
-	if(windowSec>float(c.size())/c.samplerate()/4)
-		windowSec=float(c.size())/c.samplerate()/4;
-	const unsigned window=windowSec*c.samplerate();
-	const unsigned forwardWindow=forwardWindowSec*c.samplerate();
-	const unsigned backWindow=backWindowSec*c.samplerate();
-
-	Channel factors(c);
-	Channel factors2(c);
+	const Pipeline::View s=p.view(channel);
+	const unsigned samplerate=p.input()[channel].samplerate();
+	const std::size_t size=s.size();
+	if(size==0)
+		return;
+	if(windowSec>float(size)/samplerate/4)
+		windowSec=float(size)/samplerate/4;
+	const unsigned window=windowSec*samplerate;
+	const unsigned forwardWindow=forwardWindowSec*samplerate;
+	const unsigned backWindow=backWindowSec*samplerate;
+
+	Channel factors(samplerate,size);
+	Channel factors2(samplerate,size);
+	Channel gain(samplerate,size);
 	double l2=0;
 
+	Span<float> f1=factors.span();
+	Span<float> f2=factors2.span();
+	Span<float> g=gain.span();
+	const std::size_t end=size-window/2-1;
+
 	for(unsigned j=0;j<window;j++)
-		l2+=sqr(c[j]);
+		l2+=sqr(s[j]);
 
-	for(unsigned i=window/2;i<c.size()-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		factors[i]=sqrt(l2/window);
-		if(factors[i]>maxL2)
-			maxL2=factors[i];
-		l2+=sqr(c[i+window/2])-sqr(c[i-window/2]);
+		f1[i]=sqrt(l2/window);
+		if(f1[i]>maxL2)
+			maxL2=f1[i];
+		l2+=sqr(s[i+window/2])-sqr(s[i-window/2]);
 		if(l2<0)
 			l2=0;
 	}
@@ -73,30 +130,30 @@ void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float mi
 	{
 		factors[i]=factors[window/2];//(factors[window/2]*i)/(window/2);
 	}
-	for(unsigned i=c.size()-window/2-1;i<c.size();i++)
+	for(std::size_t i=size-window/2-1;i<size;i++)
 	{
-		factors[i]=factors[c.size()-window/2-2];//(factors[c.size()-window/2-2]*(c.size()-i))/(window/2);
+		factors[i]=factors[size-window/2-2];//(factors[size-window/2-2]*(size-i))/(window/2);
 	}
 	double sum=0;
 	int    count=0;
 	for(unsigned i=0;i<window;i++)
 	{
-		if(c[i]>=factors[i])
+		if(s[i]>=factors[i])
 		{
-			sum+=c[i]*c[i];
+			sum+=s[i]*s[i];
 			count++;
 		}
 	}
-	for(unsigned i=window/2;i<c.size()-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		if(c[i-window/2]>=factors[i-window/2])
+		if(s[i-window/2]>=f1[i-window/2])
 		{
-			sum-=c[i-window/2]*c[i-window/2];
+			sum-=s[i-window/2]*s[i-window/2];
 			count--;
 		}
-		if(c[i+window/2]>=factors[i+window/2])
+		if(s[i+window/2]>=f1[i+window/2])
 		{
-			sum+=c[i+window/2]*c[i+window/2];
+			sum+=s[i+window/2]*s[i+window/2];
 			count++;
 		}
 		if(count<1)
@@ -104,9 +161,9 @@ void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float mi
 		if(sum<0)
 			sum=0;
 
-		factors2[i]=sqrt(sum/count);
-		if(factors2[i]>maxL2)
-			maxL2=factors2[i];
+		f2[i]=sqrt(sum/count);
+		if(f2[i]>maxL2)
+			maxL2=f2[i];
 
 	}
 
@@ -124,42 +181,42 @@ void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float mi
 	LOG(logINFO) << "Level minimum             : " << minLevel << std::endl;
 	LOG(logINFO) << "Level silence             : " << silentLevel << std::endl;
 
-	int c0=0,c1=0,c2=0,o=0;
+	std::size_t c0=0,c1=0,c2=0,o=0;
 
-	for(unsigned i=window/2;i<c.size()-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		if(factors2[i]<silentLevel)
+		if(f2[i]<silentLevel)
 		{
-			factors2[i]=0;
+			f2[i]=0;
 			c0++;
 		} else
-		if(factors2[i]<minLevel)
+		if(f2[i]<minLevel)
 		{
-			factors2[i]=(targetL2/factors2[i])*(factors2[i]-silentLevel)/(minLevel-silentLevel);
+			f2[i]=(targetL2/f2[i])*(f2[i]-silentLevel)/(minLevel-silentLevel);
 			c1++;
 		} else
 		{
-			factors2[i]=targetL2/factors2[i];
+			f2[i]=targetL2/f2[i];
 			c2++;
 		}
-		if(fabs(factors2[i]*c[i])>32000)
+		if(fabs(f2[i]*s[i])>32000)
 		{
-			factors2[i]=32000/fabs(c[i]);
+			f2[i]=32000/fabs(s[i]);
 			o++;
 		}
 	}
 	for(unsigned i=0;i<window/2;i++)
 		factors2[i]=(factors2[window/2]*i)/(window/2);
-	for(unsigned i=c.size()-window/2-1;i<c.size();i++)
-		factors2[i]=(factors2[c.size()-window/2-2]*(c.size()-i))/(window/2);
+	for(std::size_t i=size-window/2-1;i<size;i++)
+		factors2[i]=(factors2[size-window/2-2]*(size-i))/(window/2);
 
 	// Wave::save("factors.wav",factors);
 
 
-	LOG(logINFO) << "Silence                   : " << double(c0)/c.samplerate() << "s" << std::endl;
-	LOG(logINFO) << "Transition                : " << double(c1)/c.samplerate() << "s" << std::endl;
-	LOG(logINFO) << "Full                      : " << double(c2)/c.samplerate() << "s" << std::endl;
-	LOG(logINFO) << "Over                      : " << double(o)/c.samplerate() << "s" << std::endl;
+	LOG(logINFO) << "Silence                   : " << double(c0)/samplerate << "s" << std::endl;
+	LOG(logINFO) << "Transition                : " << double(c1)/samplerate << "s" << std::endl;
+	LOG(logINFO) << "Full                      : " << double(c2)/samplerate << "s" << std::endl;
+	LOG(logINFO) << "Over                      : " << double(o)/samplerate << "s" << std::endl;
 
 	int 	windowcount=forwardWindow;
 	double 	factorSum=0;
@@ -171,11 +228,11 @@ void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float mi
 
 
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<size;i++)
 	{
 		float f=(factorSum/windowcount);
-		if(f>factors2[i])
-			f=factors2[i];
+		if(f>f2[i])
+			f=f2[i];
 
 		movingF=(65535*movingF+f)/65536;
 
@@ -183,18 +240,18 @@ void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float mi
 			movingF=movingF/0.995+0.0001;//movingF=f/tolerance;
 		if(movingF>f*tolerance)
 			movingF*=0.999;//movingF=f*tolerance;
-		if(fabs(movingF*c[i])>32000)
-			movingF=fabs(32000./c[i]);
-		c[i]*=movingF;//f;
+		if(fabs(movingF*s[i])>32000)
+			movingF=fabs(32000./s[i]);
+		g[i]=movingF;//f;
 		//if((i%500)==0)
 		//	out << double(i)/c.samplerate() << "\t" << factors[i]<< "\t" << f << "\t" << movingF<< std::endl;
-		/*if((i%c.samplerate())==0)
+		/*if((i%samplerate)==0)
 		{
-			LOG(logDEBUG) << i/c.samplerate() << " " << factors[i] << " " << (factorSum/windowcount) << " " << factorSum << " " << windowcount << std::endl;
+			LOG(logDEBUG) << i/samplerate << " " << factors[i] << " " << (factorSum/windowcount) << " " << factorSum << " " << windowcount << std::endl;
 		}*/
-		if((int)i-(int)backWindow>=0)
+		if(i>=backWindow)
 		{
-			factorSum-=factors2[i-backWindow];
+			factorSum-=f2[i-backWindow];
 			windowcount--;
 			if(factorSum<0)
 				factorSum=0;
@@ -202,28 +259,41 @@ void SelectiveLeveler::level(Channel &c,float targetL2,double windowSec,float mi
 				windowcount=1;
 
 		}
-		if(i+forwardWindow<c.size())
+		if(i+forwardWindow<size)
 		{
-			factorSum+=factors2[i+forwardWindow];
+			factorSum+=f2[i+forwardWindow];
 			windowcount++;
 		}
 	}
+
+	p.gain(channel,gain);
 }
-void SelectiveLeveler::levelStereo(Channel &a,Channel &b,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+
+void SelectiveLeveler::levelPair(Pipeline &p,unsigned aChannel,unsigned bChannel,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
 {
 	float maxL2=0;
+	Channel &a=p.input()[aChannel];
+	Channel &b=p.input()[bChannel];
+	if(a.samplerate()!=b.samplerate() && p.pending())
+		p.apply();
 	if(a.samplerate()>b.samplerate())
-		b=b.resampleTo(a.samplerate());
+		b.resample(a.samplerate());
 	if(a.samplerate()<b.samplerate())
-		a=a.resampleTo(a.samplerate());
+		a.resample(b.samplerate());
 
-	unsigned size=a.size();
+	std::size_t size=a.size();
 	if(b.size()>a.size())
 		size=b.size();
 
 	if(size==0)
 		return;
 
+	if(a.size()<size)
+		a.resize(size);
+	if(b.size()<size)
+		b.resize(size);
+	// gain curves do not cover the appended silence, so it stays silent
+
 	if(windowSec>float(size)/a.samplerate()/4)
 		windowSec=float(size)/a.samplerate()/4;
 	const unsigned window=windowSec*a.samplerate();
@@ -231,17 +301,24 @@ void SelectiveLeveler::levelStereo(Channel &a,Channel &b,float targetL2,double w
 	const unsigned backWindow=backWindowSec*a.samplerate();
 
 	Channel factors(a.samplerate(),size);
+	Channel gain(a.samplerate(),size);
 	double l2=0;
 
+	const Pipeline::View sa=p.view(aChannel);
+	const Pipeline::View sb=p.view(bChannel);
+	Span<float> sf=factors.span();
+	Span<float> g=gain.span();
+	const std::size_t end=size-window/2-1;
+
 	for(unsigned j=0;j<window;j++)
-		l2+=sqr(a[j])+sqr(b[j]);
+		l2+=sqr(sa[j])+sqr(sb[j]);
 
-	for(unsigned i=window/2;i<size-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		factors[i]=sqrt(l2/window/2);
-		if(factors[i]>maxL2)
-			maxL2=factors[i];
-		l2+=sqr(a[i+window/2])+sqr(b[i+window/2])-sqr(a[i-window/2])-sqr(b[i-window/2]);
+		sf[i]=sqrt(l2/window/2);
+		if(sf[i]>maxL2)
+			maxL2=sf[i];
+		l2+=sqr(sa[i+window/2])+sqr(sb[i+window/2])-sqr(sa[i-window/2])-sqr(sb[i-window/2]);
 		if(l2<0)
 			l2=0;
 	}
@@ -254,34 +331,34 @@ void SelectiveLeveler::levelStereo(Channel &a,Channel &b,float targetL2,double w
 	LOG(logINFO) << "Level minimum             : " << minLevel << std::endl;
 	LOG(logINFO) << "Level silence             : " << silentLevel << std::endl;
 
-	int c0=0,c1=0,c2=0,o=0;
+	std::size_t c0=0,c1=0,c2=0,o=0;
 
-	for(unsigned i=window/2;i<size-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		if(factors[i]<silentLevel)
+		if(sf[i]<silentLevel)
 		{
-			factors[i]=0;
+			sf[i]=0;
 			c0++;
 		} else
-		if(factors[i]<minLevel)
+		if(sf[i]<minLevel)
 		{
-			factors[i]=(targetL2/factors[i])*(factors[i]-silentLevel)/(minLevel-silentLevel);
+			sf[i]=(targetL2/sf[i])*(sf[i]-silentLevel)/(minLevel-silentLevel);
 			c1++;
 		} else
 		{
-			factors[i]=targetL2/factors[i];
+			sf[i]=targetL2/sf[i];
 			c2++;
 		}
-		if(fabs(factors[i]*a[i])>32000 || fabs(factors[i]*b[i])>32000)
+		if(fabs(sf[i]*sa[i])>32000 || fabs(sf[i]*sb[i])>32000)
 		{
-			factors[i]=min(32000/fabs(a[i]),32000/fabs(b[i]));
+			sf[i]=min(32000/fabs(sa[i]),32000/fabs(sb[i]));
 			o++;
 		}
 
 	}
 	for(unsigned i=0;i<window/2;i++)
 		factors[i]=(factors[window/2]*i)/(window/2);
-	for(unsigned i=size-window/2-1;i<size;i++)
+	for(std::size_t i=size-window/2-1;i<size;i++)
 		factors[i]=(factors[size-window/2-2]*(size-i))/(window/2);
 
 	// Wave::save("factors.wav",factors);
@@ -297,45 +374,37 @@ void SelectiveLeveler::levelStereo(Channel &a,Channel &b,float targetL2,double w
 	for(unsigned i=0;i<forwardWindow;i++)
 		factorSum+=factors[i];
 
-	for(unsigned i=0;i<size;i++)
+	for(std::size_t i=0;i<size;i++)
 	{
 		float f=(factorSum/windowcount);
-		if(f>factors[i])
-			f=factors[i];
-		a[i]*=f;
-		b[i]*=f;
+		if(f>sf[i])
+			f=sf[i];
+		g[i]=f;
 		/*if((i%c.samplerate())==0)
 		{
 			LOG(logDEBUG) << i/c.samplerate() << " " << factors[i] << " " << (factorSum/windowcount) << " " << factorSum << " " << windowcount << std::endl;
 		}*/
-		if((int)i-(int)backWindow>=0)
+		if(i>=backWindow)
 		{
-			factorSum-=factors[i-backWindow];
+			factorSum-=sf[i-backWindow];
 			windowcount--;
 			if(factorSum<0)
 				factorSum=0;
 		}
 		if(i+forwardWindow<size)
 		{
-			factorSum+=factors[i+forwardWindow];
+			factorSum+=sf[i+forwardWindow];
 			windowcount++;
 		}
 	}
+
+	p.gain(aChannel,gain);
+	p.gain(bChannel,gain);
 }
 
-void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
+void SelectiveLeveler::levelMulti(Pipeline &p,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec)
 {
-	switch(mode)
-	{
-	case SINGLE:
-		level(c,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
-		return;
-	case STEREO:
-		levelStereo(c,targetL2,windowSec,minFraction,silentFraction,forwardWindowSec,backWindowSec);
-		return;
-	case MULTI:
-		break;
-	}
+	Channels &c=p.input();
 	if(c.size()==0)
 		return;
 
@@ -343,7 +412,7 @@ void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double
 
 	float maxL2=0;
 	unsigned samplerate=c[0].samplerate();
-	unsigned size=c[0].size();
+	std::size_t size=c[0].size();
 	for(unsigned i=1;i<csize;i++)
 	{
 		if(c[i].samplerate()>samplerate)
@@ -357,7 +426,7 @@ void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double
 	for(unsigned i=0;i<csize;i++)
 	{
 		if(c[i].size()<size)
-			c[i]=c[i].resizeTo(size);
+			c[i].resize(size);
 	}
 
 	if(windowSec>float(size)/samplerate/4)
@@ -367,19 +436,27 @@ void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double
 	const unsigned backWindow=backWindowSec*samplerate;
 
 	Channel factors(samplerate,size);
+	Channel gain(samplerate,size);
 	double l2=0;
 
+	std::vector<Pipeline::View> s;
+	for(unsigned k=0;k<csize;k++)
+		s.push_back(p.view(k));
+	Span<float> sf=factors.span();
+	Span<float> g=gain.span();
+	const std::size_t end=size-window/2-1;
+
 	for(unsigned j=0;j<window;j++)
 		for(unsigned i=0;i<csize;i++)
-		l2+=sqr(c[i][j]);
+		l2+=sqr(s[i][j]);
 
-	for(unsigned i=window/2;i<size-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		factors[i]=sqrt(l2/window/2);
-		if(factors[i]>maxL2)
-			maxL2=factors[i];
+		sf[i]=sqrt(l2/window/2);
+		if(sf[i]>maxL2)
+			maxL2=sf[i];
 		for(unsigned k=0;k<csize;k++)
-			l2+=sqr(c[k][i+window/2])-sqr(c[k][i-window/2]);
+			l2+=sqr(s[k][i+window/2])-sqr(s[k][i-window/2]);
 		if(l2<0)
 			l2=0;
 	}
@@ -392,35 +469,35 @@ void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double
 	LOG(logINFO) << "Level minimum             : " << minLevel << std::endl;
 	LOG(logINFO) << "Level silence             : " << silentLevel << std::endl;
 
-	int c0=0,c1=0,c2=0,o=0;
+	std::size_t c0=0,c1=0,c2=0,o=0;
 
-	for(unsigned i=window/2;i<size-window/2-1;i++)
+	for(std::size_t i=window/2;i<end;i++)
 	{
-		if(factors[i]<silentLevel)
+		if(sf[i]<silentLevel)
 		{
-			factors[i]=0;
+			sf[i]=0;
 			c0++;
 		} else
-		if(factors[i]<minLevel)
+		if(sf[i]<minLevel)
 		{
-			factors[i]=(targetL2/factors[i])*(factors[i]-silentLevel)/(minLevel-silentLevel);
+			sf[i]=(targetL2/sf[i])*(sf[i]-silentLevel)/(minLevel-silentLevel);
 			c1++;
 		} else
 		{
-			factors[i]=targetL2/factors[i];
+			sf[i]=targetL2/sf[i];
 			c2++;
 		}
 		for(unsigned k=0;k<csize;k++)
-			if(fabs(factors[i]*c[k][i])>32000)
+			if(fabs(sf[i]*s[k][i])>32000)
 			{
-				factors[i]=32000/fabs(c[k][i]);
+				sf[i]=32000/fabs(s[k][i]);
 				o++;
 			}
 
 	}
 	for(unsigned i=0;i<window/2;i++)
 		factors[i]=(factors[window/2]*i)/(window/2);
-	for(unsigned i=size-window/2-1;i<size;i++)
+	for(std::size_t i=size-window/2-1;i<size;i++)
 		factors[i]=(factors[size-window/2-2]*(size-i))/(window/2);
 
 	// Wave::save("factors.wav",factors);
@@ -436,30 +513,30 @@ void SelectiveLeveler::level(Channels &c,ChannelMode mode,float targetL2,double
 	for(unsigned i=0;i<forwardWindow;i++)
 		factorSum+=factors[i];
 
-	for(unsigned i=0;i<size;i++)
+	for(std::size_t i=0;i<size;i++)
 	{
 		float f=(factorSum/windowcount);
-		if(f>factors[i])
-			f=factors[i];
-		for(unsigned k=0;k<csize;k++)
-			c[k][i]*=f;
+		if(f>sf[i])
+			f=sf[i];
+		g[i]=f;
 		/*if((i%c.samplerate())==0)
 		{
 			LOG(logDEBUG) << i/c.samplerate() << " " << factors[i] << " " << (factorSum/windowcount) << " " << factorSum << " " << windowcount << std::endl;
 		}*/
-		if((int)i-(int)backWindow>=0)
+		if(i>=backWindow)
 		{
-			factorSum-=factors[i-backWindow];
+			factorSum-=sf[i-backWindow];
 			windowcount--;
 			if(factorSum<0)
 				factorSum=0;
 		}
 		if(i+forwardWindow<size)
 		{
-			factorSum+=factors[i+forwardWindow];
+			factorSum+=sf[i+forwardWindow];
 			windowcount++;
 		}
 	}
 
+	for(unsigned k=0;k<csize;k++)
+		p.gain(k,gain);
 }
-
@@ -11,6 +11,7 @@
 #define SELECTIVELEVELER_H_
 
 #include "Channel.h"
+#include "Pipeline.h"
 
 /**
  * @brief  Selective Leveling by windowed average l2 energy
@@ -110,8 +111,28 @@ public:
 	 */
 	static void level(Channels &aChannels,ChannelMode mode,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec);
 
+	/**
+	 * Leveling of the channels of a pipeline as in
+	 * level(Channels&,ChannelMode,float,double,float,float,float,float).
+	 * The signal is analyzed with all pending gains, and the leveling
+	 * factors are added as gain curves to the pipeline.
+	 * @param aPipeline pipeline on the channels to do the leveling on
+	 * @param mode if and how channels are joined (SINGLE, STEREO, MULTI)
+	 * @param targetL2 target average l2 energy
+	 * @param windowSec window size in seconds for l2 average energy
+	 * @param minFraction fraction compared to l2 maximal value assumed signal
+	 * @param silentFraction fraction compared to l2 maximal value assumed silence
+	 * @param forwardWindowSec average forward part of window for factor application
+	 * @param backWindowSec average backward part of window for factor application
+	 */
+	static void level(Pipeline &aPipeline,ChannelMode mode,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec);
+
 
 private:
+	static void levelSingle(Pipeline &p,unsigned channel,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec);
+	static void levelPair(Pipeline &p,unsigned aChannel,unsigned bChannel,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec);
+	static void levelMulti(Pipeline &p,float targetL2,double windowSec,float minFraction,float silentFraction,float forwardWindowSec,float backWindowSec);
+
 	template<class T>
 	static T sqr(const T&a){return a*a;}
 	template<class T>
@@ -10,8 +10,61 @@
 #include <math.h>
 
 #include "Skip.h"
+#include "FrameBuffer.h"
 #include "Log.h"
 
+/**
+ * Sum of the absolute samples of all channels for each frame. The channels
+ * are read through a frame buffer window of one block.
+ * @param a channels of equal length and sample rate
+ * @return one level per frame
+ */
+static Channel frameLevels(const Channels & a)
+{
+	std::size_t len=a[0].size();
+	Channel levels(a[0].samplerate(),len);
+	Span<float> l=levels.span();
+	FrameBuffer w(a[0].samplerate(),a.size(),FrameBuffer::blockFrames);
+
+	for(std::size_t first=0;first<len;first+=FrameBuffer::blockFrames)
+	{
+		w.load(a,first);
+		std::size_t n=len-first<FrameBuffer::blockFrames?len-first:FrameBuffer::blockFrames;
+		for(unsigned c=0;c<w.channels();c++)
+		{
+			Span<float> s=w.segment(c,0);
+			for(std::size_t j=0;j<n;j++)
+				l[first+j]+=fabs(s[j]);
+		}
+	}
+	return levels;
+}
+
+/**
+ * Writable spans on all channels
+ * @param a channels
+ * @return one span per channel
+ */
+static std::vector<Span<float> > spans(Channels & a)
+{
+	std::vector<Span<float> > s(a.size());
+	for(unsigned c=0;c<a.size();c++)
+		s[c]=a[c].span();
+	return s;
+}
+
+/**
+ * Drop the frames beyond given length
+ * @param a      channels
+ * @param frames new number of frames, longer lengths are ignored
+ */
+static void truncate(Channels & a,std::size_t frames)
+{
+	for(unsigned c=0;c<a.size();c++)
+		if(frames<a[c].size())
+			a[c].resize(frames);
+}
+
 float Skip::silence(Channels & a,float level,float minsec,float mintransition,float reductionOrder)
 {
 	if(a.size()==0)
@@ -23,42 +76,38 @@ float Skip::silence(Channels & a,float level,float minsec,float mintransition,fl
 	}
 
 
-	unsigned skip=0;
-	unsigned len=unifiedLength(a);
+	std::size_t skip=0;
+	std::size_t len=unifiedLength(a);
 	unsigned samplerate=unifiedSamplerate(a);
 
 	mintransition*=samplerate;
-	unsigned mintransition_u=(int)mintransition;
+	std::size_t mintransition_u=(std::size_t)mintransition;
+
+	Channel levels=frameLevels(a);
+	Span<const float> l=levels.view();
+	std::vector<Span<float> > s=spans(a);
 
 	float max=0;
 
-	for(unsigned i=0;i<len;i++)
-	{
-		float sum=0;
-		for(unsigned c=0;c<a.size();c++)
-			sum+=fabs(a[c][i]);
-		if(sum>max)
-			max=sum;
-	}
+	for(std::size_t i=0;i<len;i++)
+		if(l[i]>max)
+			max=l[i];
 	max/=a.size();
 
 	level*=max;
 
-	unsigned mincount=minsec*samplerate;
+	std::size_t mincount=minsec*samplerate;
 
-	for(unsigned i=0;i+skip<len;i++)
+	for(std::size_t i=0;i+skip<len;i++)
 	{
 		float sum;
-		int   d=-1;
+		long  d=-1;
 		do {
-			sum=0;
 			d++;
-			for(unsigned c=0;c<a.size();c++)
-				sum+=fabs(a[c][i+d+skip]);
-			sum/=a.size();
-		} while(sum<level && (d+int(i+skip))<int(len));
+			sum=l.get(i+d+skip)/a.size();
+		} while(sum<level && (d+long(i+skip))<long(len));
 
-		if(((unsigned)d)>mincount+mintransition_u)
+		if(std::size_t(d)>mincount+mintransition_u)
 		{
 			float delta;
 
@@ -76,30 +125,30 @@ float Skip::silence(Channels & a,float level,float minsec,float mintransition,fl
 						  << std::endl;
 
 			ndelta*=samplerate;
-			ndelta=(int)ndelta;
-			int nskip=skip+ndelta;
+			ndelta=(long)ndelta;
+			std::size_t nskip=skip+std::size_t(ndelta);
 			LOG(logDEBUG) << "From " << skip << " to " << nskip << std::endl;
 
-			int transition=d-ndelta;
+			long transition=d-long(ndelta);
 			//if(transition<mintransition)
 			//	transition=mintransition;
 
-			int padding=(d-ndelta-transition)/2;
+			long padding=(d-long(ndelta)-transition)/2;
 
 			LOG(logDEBUG) << "Transition: " << transition
 					      << " padding: " << padding << std::endl;
 
-			for(unsigned j=0;(int)j<padding;j++,i++,d--)
+			for(long j=0;j<padding;j++,i++,d--)
 				for(unsigned c=0;c<a.size();c++)
-					a[c][i]=a[c][i+skip];
+					s[c][i]=s[c].get(i+skip);
 
-			for(unsigned j=0;(int)j<transition;j++,i++,d--)
+			for(long j=0;j<transition;j++,i++,d--)
 				for(unsigned c=0;c<a.size();c++)
-					a[c][i]=((a[c][i+skip]*(transition-j))/transition+(a[c][i+nskip]*j)/transition);
+					s[c][i]=((s[c].get(i+skip)*(transition-j))/transition+(s[c].get(i+nskip)*j)/transition);
 
-			for(unsigned j=0;(int)j<padding;j++,i++,d--)
+			for(long j=0;j<padding;j++,i++,d--)
 				for(unsigned c=0;c<a.size();c++)
-					a[c][i]=a[c][i+nskip];
+					s[c][i]=s[c].get(i+nskip);
 
 			LOG(logDEBUG) << "Position now is " << double(i)/samplerate << std::endl;
 
@@ -108,15 +157,13 @@ float Skip::silence(Channels & a,float level,float minsec,float mintransition,fl
 
 		} else
 		for(;d>=0;d--,i++)
-			for(unsigned c=0;c<a.size();c++)
-				a[c][i]=a[c][i+skip];
+			if(i<len)
+				for(unsigned c=0;c<a.size();c++)
+					s[c][i]=s[c].get(i+skip);
 		i--;
 
 	}
-	for(unsigned c=0;c<a.size();c++)
-	{
-		a[c]=a[c].resizeTo(len-skip);
-	}
+	truncate(a,len-skip);
 	LOG(logDEBUG) << "Size before: " << len << " Size after: " << a[0].size()
 			<< std::endl;
 	float skipped=float(skip)/samplerate;
@@ -129,7 +176,8 @@ float Skip::silenceTarget(Channels &a,float targetFraction,float silenceLevel,fl
 	if(targetFraction>=1)
 		return 0;
 
-	unsigned samplerate=unifiedSamplerate(a),len=unifiedLength(a);
+	unsigned samplerate=unifiedSamplerate(a);
+	std::size_t len=unifiedLength(a);
 
 	float size=float(len)/samplerate;
 	float targetCut=size*(1-targetFraction);
@@ -172,52 +220,43 @@ float Skip::trim(Channels &a,float level)
 	if(a.size()==0)
 		return 0;
 
-	unsigned len=unifiedLength(a);
+	std::size_t len=unifiedLength(a);
 	unsigned samplerate=unifiedSamplerate(a);
 
+	Channel levels=frameLevels(a);
+	Span<const float> l=levels.view();
+	std::vector<Span<float> > s=spans(a);
+
 	float max=0;
 
-	for(unsigned i=0;i<len;i++)
-	{
-		float sum=0;
-		for(unsigned c=0;c<a.size();c++)
-			sum+=fabs(a[c][i]);
-		if(sum>max)
-			max=sum;
-	}
+	for(std::size_t i=0;i<len;i++)
+		if(l[i]>max)
+			max=l[i];
 
 	level*=max;
 
-	unsigned start;
+	std::size_t start;
 
 	for(start=0;start<len;start++)
 	{
-		float sum=0;
-		for(unsigned c=0;c<a.size();c++)
-			sum+=fabs(a[c][start]);
-		if(sum>level)
+		if(l[start]>level)
 			break;
 	}
 
-	unsigned end;
+	std::size_t end;
 
 	for(end=len-1;end>=start;end--)
 	{
-		float sum=0;
-		for(unsigned c=0;c<a.size();c++)
-			sum+=fabs(a[c][end]);
-		if(sum>level)
+		if(l[end]>level)
 			break;
 	}
 	LOG(logDEBUG) << "Start: " << start << " End: "<<end << std::endl;
 
-	for(unsigned c=0;c<a.size();c++)
-	{
-		unsigned j=0;
-		for(unsigned i=start;i<=end;i++,j++)
-			a[c][j]=a[c][i];
-		a[c]=a[c].resizeTo(end-start);
-	}
+	std::size_t j=0;
+	for(std::size_t i=start;i<=end;i++,j++)
+		for(unsigned c=0;c<a.size();c++)
+			s[c][j]=s[c][i];
+	truncate(a,end-start);
 
 	LOG(logDEBUG) << "Size before: " << len << " Size after: " << a[0].size() << std::endl;
 
@@ -233,58 +272,51 @@ float Skip::noise(Channels &a,float level,float minsec,float transition)
 	if(a.size()==0)
 		return 0;
 
-	unsigned skip=0;
-	unsigned len=unifiedLength(a);
+	std::size_t skip=0;
+	std::size_t len=unifiedLength(a);
 	unsigned samplerate=unifiedSamplerate(a);
 
 	if(transition>minsec/2)
 		transition=minsec/2;
 
 	minsec*=samplerate;
-	unsigned minsec_u=(unsigned)minsec;
+	std::size_t minsec_u=(std::size_t)minsec;
 
 	transition*=samplerate;
-	unsigned transition_u=(unsigned)transition;
+	std::size_t transition_u=(std::size_t)transition;
+
+	Channel levels=frameLevels(a);
+	Span<const float> l=levels.view();
+	std::vector<Span<float> > v=spans(a);
 
 	float max=0;
 
-	for(unsigned i=0;i<len;i++)
-	{
-		float sum=0;
-		for(unsigned c=0;c<a.size();c++)
-			sum+=fabs(a[c][i]);
-		if(sum>max)
-			max=sum;
-	}
+	for(std::size_t i=0;i<len;i++)
+		if(l[i]>max)
+			max=l[i];
 	max/=a.size();
 
 	level*=max;
 
-	unsigned lastend=0;
+	std::size_t lastend=0;
 
-	for(unsigned i=0;i<len;i++)
+	for(std::size_t i=0;i<len;i++)
 	{
 		float sum;
-		int   d=-1,s=-1;
+		long  d=-1,s=-1;
 		do {
 			do {
-				sum=0;
 				d++;
-				for(unsigned c=0;c<a.size();c++)
-					sum+=fabs(a[c][i+d+skip]);
-				sum/=a.size();
-			} while(sum>level && (d+int(i+skip))<int(len));
+				sum=l.get(i+d+skip)/a.size();
+			} while(sum>level && (d+long(i+skip))<long(len));
 			s=d;
 			do {
-				sum=0;
 				s++;
-				for(unsigned c=0;c<a.size();c++)
-					sum+=fabs(a[c][i+s+skip]);
-				sum/=a.size();
-			} while(sum<=level && (s+int(i+skip))<int(len));
+				sum=l.get(i+s+skip)/a.size();
+			} while(sum<=level && (s+long(i+skip))<long(len));
 			s--;
 
-		} while(s-d<(int)minsec_u && (s+int(i+skip))<int(len));
+		} while(s-d<(long)minsec_u && (s+long(i+skip))<long(len));
 		LOG(logDEBUG) << double(i)/samplerate << "/"<<double(i+skip)/samplerate<<": Found signal until "<<double(i+d)/samplerate<<std::endl;
 		LOG(logDEBUG) << double(i)/samplerate << "/"<<double(i+skip)/samplerate<<": Found silence until "<<double(i+s)/samplerate<<std::endl;
 
@@ -295,20 +327,21 @@ float Skip::noise(Channels &a,float level,float minsec,float transition)
 			lastend=i+s;
 
 			if(i>transition_u)
-				for(unsigned j=0;j<transition_u;j++)
+				for(std::size_t j=0;j<transition_u;j++)
 				{
 					double f=double(j)/transition_u;
 					for(unsigned c=0;c<a.size();c++)
-						a[c][i-transition_u+j]=a[c][i-transition_u+j]*(1-f)
-											+a[c][i+skip+j]*f;
+						v[c][i-transition_u+j]=v[c][i-transition_u+j]*(1-f)
+											+v[c].get(i+skip+j)*f;
 				}
 
 			skip+=transition_u;
 			lastend-=transition_u;
 
 			for(;i<lastend-d;i++)
-				for(unsigned c=0;c<a.size();c++)
-					a[c][i]=a[c][i+skip];
+				if(i<len)
+					for(unsigned c=0;c<a.size();c++)
+						v[c][i]=v[c].get(i+skip);
 
 			LOG(logDEBUG) << "Skip now: " << skip << " ("<<double(skip)/samplerate <<")"<< std::endl;
 			LOG(logDEBUG) << "Position now: " << i << " (" <<double(i)/samplerate << ")" << std::endl;
@@ -320,11 +353,12 @@ float Skip::noise(Channels &a,float level,float minsec,float transition)
 		i--;
 	}
 	double l1=0;
+	truncate(a,len-skip);
 	for(unsigned c=0;c<a.size();c++)
 	{
-		a[c]=a[c].resizeTo(len-skip);
-		for(unsigned i=0;i<a[c].size();i++)
-			l1+=fabs(a[c][i]);
+		Span<const float> r=a[c].view();
+		for(std::size_t i=0;i<r.size();i++)
+			l1+=fabs(r[i]);
 	}
 	l1/=(len-skip)*a.size();
 	
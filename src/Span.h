@@ -0,0 +1,158 @@
+/**
+ * @file		Span.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Unchecked contiguous views on sample data
+ */
+
+#ifndef SPAN_H_
+#define SPAN_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Unchecked view on contiguous sample data (pointer and length)
+ *
+ * In contrast to the Channel accessors there is no bounds checking on
+ * the index except for get(), so inner loops over a span can be vectorized by the compiler.
+ * A span does not own its data and gets invalid as soon as the channel it
+ * was obtained from is modified, resized or destroyed.
+ */
+template<class T>
+class Span
+{
+	T *			first;
+	std::size_t	length;
+public:
+	/**
+	 * Create an empty span
+	 */
+	Span() : first(0), length(0) {}
+
+	/**
+	 * Create a span on given data
+	 * @param aFirst  pointer to first sample
+	 * @param aLength number of samples
+	 */
+	Span(T * aFirst,std::size_t aLength) : first(aFirst), length(aLength) {}
+
+	/**
+	 * Unchecked access to a sample
+	 * @param index of sample (0<=index<size())
+	 * @return reference on sample
+	 */
+	T & operator [](std::size_t index) const { return first[index]; }
+
+	/**
+	 * Read access to a sample, zero beyond the end
+	 * @param index of sample
+	 * @return sample value or zero
+	 */
+	typename std::remove_const<T>::type get(std::size_t index) const
+	{
+		return index<length ? first[index] : 0;
+	}
+
+	/**
+	 * Pointer to the first sample
+	 * @return pointer to sample data
+	 */
+	T * data() const { return first; }
+
+	/**
+	 * Number of samples in this span
+	 * @return number of samples
+	 */
+	std::size_t size() const { return length; }
+
+	/**
+	 * Begin of sample data for iteration
+	 * @return pointer to first sample
+	 */
+	T * begin() const { return first; }
+
+	/**
+	 * End of sample data for iteration
+	 * @return pointer behind last sample
+	 */
+	T * end() const { return first+length; }
+
+	/**
+	 * Part of this span, clipped to the span boundaries
+	 * @param offset first sample of the part
+	 * @param count  number of samples of the part
+	 * @return span on the part
+	 */
+	Span sub(std::size_t offset,std::size_t count) const
+	{
+		if(offset>length)
+			offset=length;
+		if(count>length-offset)
+			count=length-offset;
+		return Span(first+offset,count);
+	}
+};
+
+/**
+ * @brief Read-only copy of sample data with explicit zero halos
+ *
+ * Windowed filters access samples before the start and after the end of
+ * a channel, and expect zero values there. The padded view adds a zero halo
+ * of given width on both sides, so indices from -halo() to size()+halo()-1
+ * can be accessed without any bounds checking.
+ */
+template<class T>
+class PaddedView
+{
+	std::vector<T>	buffer;
+	std::size_t		length;
+	std::size_t		width;
+public:
+	/**
+	 * Create an empty padded view
+	 */
+	PaddedView() : length(0), width(0) {}
+
+	/**
+	 * Create a padded copy of given samples
+	 * @param source  samples to be copied
+	 * @param aHalo   number of zero samples on either side
+	 */
+	PaddedView(Span<const T> source,std::size_t aHalo)
+		: buffer(source.size()+2*aHalo), length(source.size()), width(aHalo)
+	{
+		for(std::size_t i=0;i<length;i++)
+			buffer[width+i]=source[i];
+	}
+
+	/**
+	 * Unchecked access to a sample
+	 * @param index of sample (-halo()<=index<size()+halo())
+	 * @return sample value
+	 */
+	const T & operator [](long index) const { return buffer[width+index]; }
+
+	/**
+	 * Pointer to the first (non-halo) sample
+	 * @return pointer to sample data
+	 */
+	const T * data() const { return buffer.data()+width; }
+
+	/**
+	 * Number of samples without the halos
+	 * @return number of samples
+	 */
+	std::size_t size() const { return length; }
+
+	/**
+	 * Width of the zero halo on either side
+	 * @return number of zero samples before and after the data
+	 */
+	std::size_t halo() const { return width; }
+};
+
+#endif /* SPAN_H_ */
@@ -0,0 +1,282 @@
+/**
+ * @file		Statistics.cpp
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Fused and vectorized statistics on sample data
+ */
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Statistics.h"
+#include "Log.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STATISTICS_X86
+#include <immintrin.h>
+#endif
+
+typedef void (*NormsKernel)(const float *,std::size_t,double &,float &);
+typedef void (*SplitKernel)(const float *,std::size_t,float,double &,std::size_t &,double &,std::size_t &);
+
+static void normsScalar(const float * d,std::size_t n,double & sumSquares,float & maxAbs)
+{
+	for(std::size_t i=0;i<n;i++)
+	{
+		float v=d[i]*d[i];
+		sumSquares+=v;
+		if(d[i]>maxAbs)
+			maxAbs=d[i];
+		if(-d[i]>maxAbs)
+			maxAbs=-d[i];
+	}
+}
+
+static void splitScalar(const float * d,std::size_t n,float limit2,
+		                double & upSquares,std::size_t & upCount,
+		                double & downSquares,std::size_t & downCount)
+{
+	for(std::size_t i=0;i<n;i++)
+	{
+		float v=d[i]*d[i];
+		if(v>limit2)
+		{
+			upSquares+=v;
+			upCount++;
+		}
+		if(v<limit2)
+		{
+			downSquares+=v;
+			downCount++;
+		}
+	}
+}
+
+#ifdef STATISTICS_X86
+
+/**
+ * Sum of the lanes of a double accumulator
+ */
+static double lanes(const double * v,unsigned n)
+{
+	double sum=0;
+	for(unsigned i=0;i<n;i++)
+		sum+=v[i];
+	return sum;
+}
+
+__attribute__((target("sse2")))
+static void normsSse2(const float * d,std::size_t n,double & sumSquares,float & maxAbs)
+{
+	__m128d s0=_mm_setzero_pd(),s1=_mm_setzero_pd();
+	__m128  m=_mm_setzero_ps();
+	const __m128 sign=_mm_set1_ps(-0.0f);
+	std::size_t i=0;
+
+	for(;i+4<=n;i+=4)
+	{
+		__m128 v=_mm_loadu_ps(d+i);
+		__m128 q=_mm_mul_ps(v,v);
+		s0=_mm_add_pd(s0,_mm_cvtps_pd(q));
+		s1=_mm_add_pd(s1,_mm_cvtps_pd(_mm_movehl_ps(q,q)));
+		m=_mm_max_ps(_mm_andnot_ps(sign,v),m);
+	}
+
+	double s[4];
+	float  a[4];
+	_mm_storeu_pd(s,s0);
+	_mm_storeu_pd(s+2,s1);
+	_mm_storeu_ps(a,m);
+
+	sumSquares+=lanes(s,4);
+	for(unsigned k=0;k<4;k++)
+		if(a[k]>maxAbs)
+			maxAbs=a[k];
+
+	normsScalar(d+i,n-i,sumSquares,maxAbs);
+}
+
+__attribute__((target("sse2")))
+static void splitSse2(const float * d,std::size_t n,float limit2,
+		              double & upSquares,std::size_t & upCount,
+		              double & downSquares,std::size_t & downCount)
+{
+	__m128d u0=_mm_setzero_pd(),u1=_mm_setzero_pd();
+	__m128d w0=_mm_setzero_pd(),w1=_mm_setzero_pd();
+	__m128i cu=_mm_setzero_si128(),cw=_mm_setzero_si128();
+	const __m128 limit=_mm_set1_ps(limit2);
+	std::size_t i=0;
+
+	for(;i+4<=n;i+=4)
+	{
+		__m128 v=_mm_loadu_ps(d+i);
+		__m128 q=_mm_mul_ps(v,v);
+		__m128 up=_mm_cmpgt_ps(q,limit);
+		__m128 down=_mm_cmplt_ps(q,limit);
+		__m128 qu=_mm_and_ps(q,up);
+		__m128 qw=_mm_and_ps(q,down);
+		u0=_mm_add_pd(u0,_mm_cvtps_pd(qu));
+		u1=_mm_add_pd(u1,_mm_cvtps_pd(_mm_movehl_ps(qu,qu)));
+		w0=_mm_add_pd(w0,_mm_cvtps_pd(qw));
+		w1=_mm_add_pd(w1,_mm_cvtps_pd(_mm_movehl_ps(qw,qw)));
+		cu=_mm_sub_epi32(cu,_mm_castps_si128(up));
+		cw=_mm_sub_epi32(cw,_mm_castps_si128(down));
+	}
+
+	double   s[4];
+	unsigned c[4];
+	_mm_storeu_pd(s,u0);
+	_mm_storeu_pd(s+2,u1);
+	upSquares+=lanes(s,4);
+	_mm_storeu_pd(s,w0);
+	_mm_storeu_pd(s+2,w1);
+	downSquares+=lanes(s,4);
+	_mm_storeu_si128((__m128i*)c,cu);
+	upCount+=c[0]+c[1]+c[2]+c[3];
+	_mm_storeu_si128((__m128i*)c,cw);
+	downCount+=c[0]+c[1]+c[2]+c[3];
+
+	splitScalar(d+i,n-i,limit2,upSquares,upCount,downSquares,downCount);
+}
+
+__attribute__((target("avx2")))
+static void normsAvx2(const float * d,std::size_t n,double & sumSquares,float & maxAbs)
+{
+	__m256d s0=_mm256_setzero_pd(),s1=_mm256_setzero_pd();
+	__m256  m=_mm256_setzero_ps();
+	const __m256 sign=_mm256_set1_ps(-0.0f);
+	std::size_t i=0;
+
+	for(;i+8<=n;i+=8)
+	{
+		__m256 v=_mm256_loadu_ps(d+i);
+		__m256 q=_mm256_mul_ps(v,v);
+		s0=_mm256_add_pd(s0,_mm256_cvtps_pd(_mm256_castps256_ps128(q)));
+		s1=_mm256_add_pd(s1,_mm256_cvtps_pd(_mm256_extractf128_ps(q,1)));
+		m=_mm256_max_ps(_mm256_andnot_ps(sign,v),m);
+	}
+
+	double s[8];
+	float  a[8];
+	_mm256_storeu_pd(s,s0);
+	_mm256_storeu_pd(s+4,s1);
+	_mm256_storeu_ps(a,m);
+
+	sumSquares+=lanes(s,8);
+	for(unsigned k=0;k<8;k++)
+		if(a[k]>maxAbs)
+			maxAbs=a[k];
+
+	normsScalar(d+i,n-i,sumSquares,maxAbs);
+}
+
+__attribute__((target("avx2")))
+static void splitAvx2(const float * d,std::size_t n,float limit2,
+		              double & upSquares,std::size_t & upCount,
+		              double & downSquares,std::size_t & downCount)
+{
+	__m256d u0=_mm256_setzero_pd(),u1=_mm256_setzero_pd();
+	__m256d w0=_mm256_setzero_pd(),w1=_mm256_setzero_pd();
+	__m256i cu=_mm256_setzero_si256(),cw=_mm256_setzero_si256();
+	const __m256 limit=_mm256_set1_ps(limit2);
+	std::size_t i=0;
+
+	for(;i+8<=n;i+=8)
+	{
+		__m256 v=_mm256_loadu_ps(d+i);
+		__m256 q=_mm256_mul_ps(v,v);
+		__m256 up=_mm256_cmp_ps(q,limit,_CMP_GT_OQ);
+		__m256 down=_mm256_cmp_ps(q,limit,_CMP_LT_OQ);
+		__m256 qu=_mm256_and_ps(q,up);
+		__m256 qw=_mm256_and_ps(q,down);
+		u0=_mm256_add_pd(u0,_mm256_cvtps_pd(_mm256_castps256_ps128(qu)));
+		u1=_mm256_add_pd(u1,_mm256_cvtps_pd(_mm256_extractf128_ps(qu,1)));
+		w0=_mm256_add_pd(w0,_mm256_cvtps_pd(_mm256_castps256_ps128(qw)));
+		w1=_mm256_add_pd(w1,_mm256_cvtps_pd(_mm256_extractf128_ps(qw,1)));
+		cu=_mm256_sub_epi32(cu,_mm256_castps_si256(up));
+		cw=_mm256_sub_epi32(cw,_mm256_castps_si256(down));
+	}
+
+	double   s[8];
+	unsigned c[8];
+	_mm256_storeu_pd(s,u0);
+	_mm256_storeu_pd(s+4,u1);
+	upSquares+=lanes(s,8);
+	_mm256_storeu_pd(s,w0);
+	_mm256_storeu_pd(s+4,w1);
+	downSquares+=lanes(s,8);
+	_mm256_storeu_si256((__m256i*)c,cu);
+	for(unsigned k=0;k<8;k++)
+		upCount+=c[k];
+	_mm256_storeu_si256((__m256i*)c,cw);
+	for(unsigned k=0;k<8;k++)
+		downCount+=c[k];
+
+	splitScalar(d+i,n-i,limit2,upSquares,upCount,downSquares,downCount);
+}
+
+#endif
+
+/**
+ * Kernels for the processor in use, selected on first use
+ */
+struct StatisticsKernels
+{
+	NormsKernel  norms;
+	SplitKernel  split;
+	const char * name;
+
+	StatisticsKernels() : norms(normsScalar), split(splitScalar), name("scalar")
+	{
+#ifdef STATISTICS_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2"))
+		{
+			norms=normsAvx2;
+			split=splitAvx2;
+			name="avx2";
+		} else
+		if(__builtin_cpu_supports("sse2"))
+		{
+			norms=normsSse2;
+			split=splitSse2;
+			name="sse2";
+		}
+#endif
+		LOG(logDEBUG) << "Using " << name << " statistics kernels" << std::endl;
+	}
+};
+
+static const StatisticsKernels & kernels()
+{
+	static StatisticsKernels k;
+	return k;
+}
+
+void Statistics::norms(Span<const float> data,double & sumSquares,float & maxAbs)
+{
+	sumSquares=0;
+	maxAbs=0;
+	kernels().norms(data.data(),data.size(),sumSquares,maxAbs);
+}
+
+void Statistics::split(Span<const float> data,float limit2,
+		               double & upSquares,std::size_t & upCount,
+		               double & downSquares,std::size_t & downCount)
+{
+	upSquares=downSquares=0;
+	upCount=downCount=0;
+
+	// the vector kernels count in 32 bit lanes
+	const std::size_t piece=std::size_t(1)<<30;
+	for(std::size_t i=0;i<data.size();i+=piece)
+		kernels().split(data.data()+i,std::min(data.size()-i,piece),limit2,
+				        upSquares,upCount,downSquares,downCount);
+}
+
+const char * Statistics::kernel()
+{
+	return kernels().name;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file		Statistics.h
+ * @author  	Sebastian Ritterbusch <ospac@ritterbusch.de>
+ * @version 	1.0
+ * @date		17.10.2026
+ * @copyright	MIT License (see LICENSE file)
+ * @brief 		Fused and vectorized statistics on sample data
+ */
+
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include "Span.h"
+
+/**
+ * @brief Cached statistics of a channel
+ *
+ * The norms of a channel are computed in two fused passes: The first pass
+ * yields the sum of squares and the maximum absolute value, the second
+ * pass the sums of squares above and below a given limit. The results are
+ * kept until the channel is modified.
+ */
+struct ChannelStatistics
+{
+	bool		hasNorms;		///< sumSquares and maxAbs are valid
+	double		sumSquares;		///< sum of all squared samples
+	float		maxAbs;			///< maximum absolute sample value
+
+	bool		hasSplit;		///< the split values are valid for splitLimit
+	float		splitLimit;		///< limit (not squared) of the split sums
+	double		upSquares;		///< sum of squared samples above the limit
+	std::size_t	upCount;		///< number of samples above the limit
+	double		downSquares;	///< sum of squared samples below the limit
+	std::size_t	downCount;		///< number of samples below the limit
+
+	ChannelStatistics() : hasNorms(false), sumSquares(0), maxAbs(0),
+			              hasSplit(false), splitLimit(0),
+			              upSquares(0), upCount(0),
+			              downSquares(0), downCount(0) {}
+
+	/**
+	 * Invalidate all values after a modification of the samples
+	 */
+	void reset() { hasNorms=hasSplit=false; }
+};
+
+/**
+ * @brief Statistics kernels on sample data
+ *
+ * The float kernels are vectorized with SSE2 or AVX2, the variant is
+ * chosen at run time depending on the capabilities of the processor.
+ * Squares are computed in single precision and summed up in double
+ * precision as in the scalar variants, only the order of the summation
+ * differs.
+ */
+class Statistics
+{
+public:
+	/**
+	 * Sum of squares and maximum absolute value in one pass
+	 * @param data       samples
+	 * @param sumSquares sum of squared samples
+	 * @param maxAbs     maximum absolute sample value (at least 0)
+	 */
+	static void norms(Span<const float> data,double & sumSquares,float & maxAbs);
+
+	/**
+	 * Sums of squares above and below a limit in one pass
+	 * @param data        samples
+	 * @param limit2      squared limit
+	 * @param upSquares   sum of squared samples with square above limit2
+	 * @param upCount     number of samples with square above limit2
+	 * @param downSquares sum of squared samples with square below limit2
+	 * @param downCount   number of samples with square below limit2
+	 */
+	static void split(Span<const float> data,float limit2,
+			          double & upSquares,std::size_t & upCount,
+			          double & downSquares,std::size_t & downCount);
+
+	/**
+	 * Scalar sum of squares and maximum absolute value for other sample types
+	 * @param data       samples
+	 * @param sumSquares sum of squared samples
+	 * @param maxAbs     maximum absolute sample value (at least 0)
+	 */
+	template<class T>
+	static void norms(Span<const T> data,double & sumSquares,float & maxAbs)
+	{
+		sumSquares=0;
+		maxAbs=0;
+		for(std::size_t i=0;i<data.size();i++)
+		{
+			float v=data[i];
+			sumSquares+=v*v;
+			if(v>maxAbs)
+				maxAbs=v;
+			if(-v>maxAbs)
+				maxAbs=-v;
+		}
+	}
+
+	/**
+	 * Scalar sums of squares above and below a limit for other sample types
+	 * @param data        samples
+	 * @param limit2      squared limit
+	 * @param upSquares   sum of squared samples with square above limit2
+	 * @param upCount     number of samples with square above limit2
+	 * @param downSquares sum of squared samples with square below limit2
+	 * @param downCount   number of samples with square below limit2
+	 */
+	template<class T>
+	static void split(Span<const T> data,float limit2,
+			          double & upSquares,std::size_t & upCount,
+			          double & downSquares,std::size_t & downCount)
+	{
+		upSquares=downSquares=0;
+		upCount=downCount=0;
+		for(std::size_t i=0;i<data.size();i++)
+		{
+			float v=data[i];
+			v*=v;
+			if(v>limit2)
+			{
+				upSquares+=v;
+				upCount++;
+			}
+			if(v<limit2)
+			{
+				downSquares+=v;
+				downCount++;
+			}
+		}
+	}
+
+	/**
+	 * Name of the kernel variant in use
+	 * @return "avx2", "sse2" or "scalar"
+	 */
+	static const char * kernel();
+};
+
+#endif /* STATISTICS_H_ */
@@ -24,23 +24,23 @@ void StereoMix::mix(Channel &c,float leftFactor,float rightFactor,float leftDist
 {
 	if(target[0].size()==0 || c.samplerate()>target[0].samplerate())
 	{
-		target[0]=target[0].resampleTo(c.samplerate());
-		target[1]=target[1].resampleTo(c.samplerate());
+		target[0].resample(c.samplerate());
+		target[1].resample(c.samplerate());
 		LOG(logDEBUG) << "Target samplerate set to " << c.samplerate() << std::endl;
 	}
 	if(c.samplerate()<target[0].samplerate())
-		c.resampleTo(target[0].samplerate());
+		c.resample(target[0].samplerate());
 	if(target[0].size()<c.size())
 	{
-		target[0]=target[0].resizeTo(c.size());
-		target[1]=target[1].resizeTo(c.size());
+		target[0].resize(c.size());
+		target[1].resize(c.size());
 		LOG(logDEBUG) << "Target size set to " << c.size()/c.samplerate() << "s"<< std::endl;
 	}
 
 	unsigned leftShift=Physics::meterToSec(leftDistance)*c.samplerate();
 	unsigned rightShift=Physics::meterToSec(rightDistance)*c.samplerate();
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 	{
 		if(i>=leftShift)
 			target[0][i]+=leftFactor*c[i-leftShift];
@@ -60,16 +60,16 @@ void StereoMix::mixBanded(Channel &c,float leftFactor,float rightFactor,float le
 
 	if(target[0].size()==0 || c.samplerate()>target[0].samplerate())
 	{
-		target[0]=target[0].resampleTo(c.samplerate());
-		target[1]=target[1].resampleTo(c.samplerate());
+		target[0].resample(c.samplerate());
+		target[1].resample(c.samplerate());
 		LOG(logDEBUG) << "Target samplerate set to " << c.samplerate() << std::endl;
 	}
 	if(c.samplerate()<target[0].samplerate())
-		c.resampleTo(target[0].samplerate());
+		c.resample(target[0].samplerate());
 	if(target[0].size()<c.size())
 	{
-		target[0]=target[0].resizeTo(c.size());
-		target[1]=target[1].resizeTo(c.size());
+		target[0].resize(c.size());
+		target[1].resize(c.size());
 		LOG(logDEBUG) << "Target size set to " << c.size()/c.samplerate() << "s"<< std::endl;
 	}
 
@@ -86,7 +86,7 @@ void StereoMix::mixBanded(Channel &c,float leftFactor,float rightFactor,float le
 	float r2=pow(rightFactor,1.2);
 	float r3=pow(rightFactor,1.6);
 
-	for(unsigned i=0;i<c.size();i++)
+	for(std::size_t i=0;i<c.size();i++)
 	{
 		if(i>=leftShift)
 		{
@@ -119,10 +119,17 @@ void StereoMix::mixBanded(Channel &c,float leftFactor,float rightFactor,float le
 }
 
 
-void StereoMix::mix(Channels &c,float maxfactor,bool spatial,float maxdelay, bool banded)
+void StereoMix::position(unsigned channel,unsigned channels,float maxfactor,bool spatial,float maxdelay,
+		                 float &leftFactor,float &rightFactor,float &leftDistance,float &rightDistance)
 {
-	if(c.size()==0)
+	if(channels==1)
+	{
+		leftFactor=1;
+		rightFactor=1;
+		leftDistance=0;
+		rightDistance=0;
 		return;
+	}
 
 	const int sets=3;
 	const int vars=4;
@@ -148,34 +155,65 @@ void StereoMix::mix(Channels &c,float maxfactor,bool spatial,float maxdelay, boo
 			for(int j=0;j<vars;j++)
 				settings[i][j]=settingsStereo[i][j];
 
-	if(c.size()==1)
-		mix(c[0],1,1,0,0);
-	else
+	double p=double(channel)*(sets-1)/(channels-1);
+	int    pi=int(p);
+	if(pi==sets)
+		pi--;
+	double f=p-pi;
+	LOG(logINFO) << "Mixing channel " << channel
+			     << " Vl=" << settings[pi][0]*(1-f)+settings[pi+1][0]*f
+				 << " Vr=" << settings[pi][1]*(1-f)+settings[pi+1][1]*f
+				 << " tl=" << settings[pi][2]*(1-f)+settings[pi+1][2]*f << "s"
+				 << " tr=" << settings[pi][3]*(1-f)+settings[pi+1][3]*f << "s" << std::endl;
+
+	leftFactor=settings[pi][0]*(1-f)+settings[pi+1][0]*f;
+	rightFactor=settings[pi][1]*(1-f)+settings[pi+1][1]*f;
+	leftDistance=settings[pi][2]*(1-f)+settings[pi+1][2]*f;
+	rightDistance=settings[pi][3]*(1-f)+settings[pi+1][3]*f;
+}
+
+void StereoMix::mix(Channels &c,float maxfactor,bool spatial,float maxdelay, bool banded)
+{
+	if(c.size()==0)
+		return;
+
+	for(std::size_t i=0;i<c.size();i++)
 	{
-		for(unsigned i=0;i<c.size();i++)
-		{
-			double p=double(i)*(sets-1)/(c.size()-1);
-			int    pi=int(p);
-			if(pi==sets)
-				pi--;
-			double f=p-pi;
-			LOG(logINFO) << "Mixing channel " << i
-					     << " Vl=" << settings[pi][0]*(1-f)+settings[pi+1][0]*f
-						 << " Vr=" << settings[pi][1]*(1-f)+settings[pi+1][1]*f
-						 << " tl=" << settings[pi][2]*(1-f)+settings[pi+1][2]*f << "s"
-						 << " tr=" << settings[pi][3]*(1-f)+settings[pi+1][3]*f << "s" << std::endl;
-
-			if(banded)
-				mixBanded(c[i],settings[pi][0]*(1-f)+settings[pi+1][0]*f
-												,settings[pi][1]*(1-f)+settings[pi+1][1]*f
-												,settings[pi][2]*(1-f)+settings[pi+1][2]*f
-												,settings[pi][3]*(1-f)+settings[pi+1][3]*f);
-			else
-				mix(c[i],settings[pi][0]*(1-f)+settings[pi+1][0]*f
-						,settings[pi][1]*(1-f)+settings[pi+1][1]*f
-						,settings[pi][2]*(1-f)+settings[pi+1][2]*f
-						,settings[pi][3]*(1-f)+settings[pi+1][3]*f);
-		}
+		float leftFactor,rightFactor,leftDistance,rightDistance;
+		position(i,c.size(),maxfactor,spatial,maxdelay,leftFactor,rightFactor,leftDistance,rightDistance);
+
+		if(banded && c.size()>1)
+			mixBanded(c[i],leftFactor,rightFactor,leftDistance,rightDistance);
+		else
+			mix(c[i],leftFactor,rightFactor,leftDistance,rightDistance);
 	}
 }
 
+void StereoMix::mix(Pipeline &p,float maxfactor,bool spatial,float maxdelay, bool banded)
+{
+	if(p.channels()==0)
+		return;
+
+	if((banded && p.channels()>1) || !p.uniform() ||
+	   (target[0].size()!=0 && target[0].samplerate()!=p.input()[0].samplerate()))
+	{
+		p.apply();
+		mix(p.input(),maxfactor,spatial,maxdelay,banded);
+		p.finish(target);
+		return;
+	}
+
+	const unsigned samplerate=p.input()[0].samplerate();
+	Pipeline::MixMatrix matrix(2);
+	for(unsigned i=0;i<p.channels();i++)
+	{
+		float leftFactor,rightFactor,leftDistance,rightDistance;
+		position(i,p.channels(),maxfactor,spatial,maxdelay,leftFactor,rightFactor,leftDistance,rightDistance);
+
+		unsigned leftShift=Physics::meterToSec(leftDistance)*samplerate;
+		unsigned rightShift=Physics::meterToSec(rightDistance)*samplerate;
+		matrix[0].push_back(Pipeline::Tap(i,leftFactor,leftShift));
+		matrix[1].push_back(Pipeline::Tap(i,rightFactor,rightShift));
+	}
+	p.mix(matrix,target);
+}
@@ -11,6 +11,7 @@
 #define STEREOMIX_H_
 
 #include "Channel.h"
+#include "Pipeline.h"
 
 /**
  * @brief  Create stereo mixdown of channels
@@ -55,11 +56,39 @@ public:
 	 */
 	void        mix(Channels &c,float maxfactor=0.9,bool spatial=false,float maxdelay=0.03, bool banded=false);
 
+	/**
+	 * Mix channels of a pipeline into target using equidistant positions.
+	 * Pending gains and the limiter of the pipeline are applied in the same
+	 * sweep as the mixing, unless the mix is banded or the sample rates differ.
+	 * @param p			Pipeline on the channels
+	 * @param maxfactor Maximum factor for spatial volume change
+	 * @param spatial	Use spatial delay?
+	 * @param maxdelay  Maximum interaural delay
+	 * @param banded	Use frequency dependence?
+	 */
+	void        mix(Pipeline &p,float maxfactor=0.9,bool spatial=false,float maxdelay=0.03, bool banded=false);
+
 	/**
 	 * Request current stereo mixdown
 	 * @return stereo mixdown
 	 */
 	Channels &	getTarget() { return target; }
+
+private:
+	/**
+	 * Equidistant position of a channel in the stereo mix-down
+	 * @param channel		index of channel
+	 * @param channels		number of channels
+	 * @param maxfactor		Maximum factor for spatial volume change
+	 * @param spatial		Use spatial delay?
+	 * @param maxdelay		Maximum interaural delay
+	 * @param leftFactor	Rendering intensity left target channel
+	 * @param rightFactor	Rendering intensity right target channel
+	 * @param leftDistance	Distance in meter from left channel
+	 * @param rightDistance	Distance in meter from right channel
+	 */
+	static void	position(unsigned channel,unsigned channels,float maxfactor,bool spatial,float maxdelay,
+			             float &leftFactor,float &rightFactor,float &leftDistance,float &rightDistance);
 };
 
 #endif /* STEREOMIX_H_ */
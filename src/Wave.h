@@ -15,6 +15,7 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 
 #include "Channel.h"
 
@@ -24,6 +25,15 @@
 class Wave
 {
 public:
+	/**
+	 * Sample format of saved wave files
+	 */
+	enum SampleFormat {
+		PCM16,		//!< 16 bit integer samples
+		PCM24,		//!< 24 bit integer samples
+		FLOAT32		//!< 32 bit float samples, not limited to the range
+	};
+
 	/**
 	 * Load a wave file from the file system using libsndfile.
 	 * @param  name 	file system name of file
@@ -35,7 +45,9 @@ public:
 
 	/**
 	 * Load a wave file from the file system using libsndfile, avoiding
-	 * copy operations.
+	 * copy operations. Uncompressed files are converted from a memory
+	 * mapping (see MappedWave), but the channels always hold a converted
+	 * copy of the samples.
 	 * @param name		file system name of file
 	 * @param target	Channel object to save the data in
 	 * @param skip      skip seconds
@@ -44,6 +56,19 @@ public:
 	 */
 	static Channels & load(const std::string &,Channels & target,float skip=0,float length=1e+99);
 
+	/**
+	 * Load a wave file from the file system using libsndfile into channels
+	 * with compact 16 bit samples, using half of the memory of float channels.
+	 * Mono 16 bit wave files are not copied, the channel shares the pages
+	 * of the file until they are modified.
+	 * @param name		file system name of file
+	 * @param target	ShortChannels object to save the data in
+	 * @param skip      skip seconds
+	 * @param length	maximum length to load (after skip)
+	 * @return ShortChannels references containing the wave channels
+	 */
+	static ShortChannels & load(const std::string &,ShortChannels & target,float skip=0,float length=1e+99);
+
 #ifdef HAS_FFMPEG
 	/**
 	 * Load a wave file from the file system using libavcodec.
@@ -68,7 +93,8 @@ public:
 	/**
 	 * Save a multi-channel aac file to the file system using libffmpeg.
 	 * The sample data is assumed to be in the range of [-32767,32767] and
-	 * entries beyond are limited to the range.
+	 * entries beyond are limited to the range. Names ending in .aac are
+	 * written as raw ADTS, others in an MP4/M4A container (see AacSink).
 	 * @param name		file system name of file
 	 * @param channels	channels to be saved.
 	 * @param bitrate	bitrate in bits per second
@@ -90,8 +116,10 @@ public:
 #endif // HAS_FFMPEG
 
 	/**
-	* Load a ascii wave file from the file system using libsndfile, avoiding
-	* copy operations. This routine rescales the input to [-32000,32000].
+	* Load a ascii wave file from the file system, avoiding copy operations.
+	* Files with the same number of values on each line are loaded as one
+	* channel per column. This routine rescales each channel to
+	* [-32000,32000].
 	* @param name		file system name of file
 	* @param samplerate sample rate of file
 	* @param target	Channel object to save the data in
@@ -104,12 +132,59 @@ public:
 	/**
 	 * Save a multi-channel wave file to the file system using libsndfile.
 	 * The sample data is assumed to be in the range of [-32767,32767] and
-	 * entries beyond are limited to the range.
+	 * entries beyond are limited to the range for integer formats.
+	 * Blocks of frames are converted on a second thread while the previous
+	 * block is written. Files beyond the 4GB limit of wave files are
+	 * written as RF64, names ending in .w64, .caf or .rf64 select these
+	 * containers.
+	 * @param name		file system name of file
+	 * @param channels	channels to be saved.
+	 * @param format	sample format of file
+	 * @return	0 in case of success, 1 in case of error.
+	 */
+	static int      save(const std::string &,Channels &,SampleFormat format=PCM16);
+
+	/**
+	 * Meta data of a saved file as pairs of libsndfile string types
+	 * (SF_STR_TITLE, SF_STR_ARTIST, ...) and their values
+	 */
+	typedef std::vector<std::pair<int,std::string> > Strings;
+
+	/**
+	 * Save a multi-channel file in any format of libsndfile, including
+	 * FLAC, Ogg Vorbis, Opus and MP3 of recent versions of libsndfile.
+	 * The sample data is assumed to be in the range of [-32767,32767].
 	 * @param name		file system name of file
 	 * @param channels	channels to be saved.
+	 * @param format	libsndfile major and minor format, e.g.
+	 *                  SF_FORMAT_OGG|SF_FORMAT_VORBIS
+	 * @param quality	variable bit rate quality in [0,1], negative to use
+	 *                  the default of the encoder
+	 * @param strings	meta data of file
+	 * @return	0 in case of success, 1 in case of error.
+	 */
+	static int      save(const std::string & name,Channels & channels,int format,double quality,
+			             const Strings & strings);
+
+	/**
+	 * Check if the linked libsndfile can write a format
+	 * @param format		libsndfile major and minor format
+	 * @param channels		number of channels
+	 * @param samplerate	sample rate
+	 * @return true if files of the format can be written
+	 */
+	static bool     supports(int format,unsigned channels,unsigned samplerate);
+
+	/**
+	 * Stream a 16 bit wave file to a file descriptor, e.g. a pipe to an
+	 * external encoder. The header is written first with the final sizes,
+	 * so the descriptor does not need to be seekable.
+	 * @param fd		file descriptor to write to
+	 * @param channels	channels to be written
+	 * @param name		name of the target for messages
 	 * @return	0 in case of success, 1 in case of error.
 	 */
-	static int      save(const std::string &,Channels &);
+	static int      write(int fd,Channels & channels,const std::string & name);
 
 	/**
 	 * Save a single-channel wave file to the file system using libsndfile.
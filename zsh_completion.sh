@@ -7,10 +7,13 @@ _ospac(){
   opts=(
     "*: :_files"
     '*--quality[Quality from 0-low, 1-standard, 2-high, 3-insane]: :(0 1 2 3)'
-  '*--mp3[Write final output to the file using external lame]: :_files'
+  '*--mp3[Write final output to the file using libsndfile or lame]: :_files'
   '*--output[Write final output to the file in netbpm format]: :_files'
+  '*--bits[Wave output with 16 or 24 bit integer or 32 bit float samples]: :(16 24 32)'
   '*--plot[Write final output to the file in wave format]: :_files'
-  '*--ogg[Write final output to the file using external oggenc]: :_files'
+  '*--ogg[Write final output to the file using libsndfile or oggenc]: :_files'
+  '*--flac[Write final output to the file in flac format]: :_files'
+  '*--opus[Write final output to the file in opus format]: :_files'
   '*--highpass[<f> <t> Highpass above f Hertz, sharpness t Hertz]: :'
   '*--leveler[Enable selective leveler]'
   '*--no-factor[Disable channel multiplier]'
@@ -26,6 +29,10 @@ _ospac(){
   '*--factor[Multiply channels by the given factor with sigmoid limiter (1.25)]: :'
   '*--no-eqvoice[Do not attenuate frequency bands]'
   '*--verbosity[Set the verbosity level]: :(0 1 2 3 4 5 6)'
+  '*--plan[Project memory and cost of all stages without processing]'
+  '*--max-memory[<n> Keep at most n MB of samples in memory, spill the rest to temporary files]: :'
+  '*--cache[<dir> Cache decoded compressed inputs in directory dir]: :_files -/'
+  '*--cache-size[<n> Keep at most n MB of decoded inputs in the cache]: :'
   '*--help[Display the help text]'
   '*--no-xfilter[Disable crosstalk filter]'
   '*--no-xgate[Disable crosstalk gate]'
@@ -38,6 +45,8 @@ _ospac(){
   '*--ascii[<s> <file> Load ascii wave file with sample rate s]: :'
   '*--left[Load left channel of wave file (if stereo)]: :_files'
   '*--to-mono[Load mono-mixdown of wave file (if stereo)]: :_files'
+  '*--load-skip[<s> Skip first s seconds of following inputs]: :'
+  '*--load-length[<s> Load at most s seconds of following inputs]: :'
   '*--album[Set the album tag if this exists in the output]: :'
   '*--category[Set the category tag if this exists in the output]: :'
   '*--title[Set the title tag if this exists in the output]: :'